@@ -0,0 +1,28 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+
+// A run of consecutive sprite slots shown frameTime milliseconds each, looping. A still pose is a
+// clip of one frame.
+struct AnimationClip {
+    uint8_t first = 0;
+    uint8_t frameCount = 1;
+    uint16_t frameTime = 1;
+};
+
+// Clips looked up by a key made of state bits, built at compile time. Picking a sprite is an index
+// and a division however many poses there are, so adding one only adds rows to the table.
+template <unsigned int KeyCount>
+struct AnimationTable {
+    std::array<AnimationClip, KeyCount> clips{};
+
+    // param: key : state bits, less than KeyCount.
+    // param: time : milliseconds on a clock shared by everything animated, so no entity keeps
+    // animation state of its own.
+    // return : sprite slot to draw.
+    constexpr unsigned int Sprite(unsigned int key, unsigned int time) const {
+        const AnimationClip& clip = clips[key];
+        return clip.first + time / clip.frameTime % clip.frameCount;
+    }
+};
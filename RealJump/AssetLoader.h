@@ -0,0 +1,140 @@
+#pragma once
+
+#include <atomic>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "AssetRegistry.h"
+#include "ThreadPool.h"
+
+#if !defined(_WINDOWS)
+    #include "FrameworkHeadless.h"
+#endif
+
+// What needs a sprite. The game waits on the groups it needs rather than on every sprite.
+enum AssetGroup {
+    ASSETS_GAMEPLAY,
+    ASSETS_HUD,
+    ASSET_GROUP_COUNT
+};
+
+// Streams requested sprites into an AssetRegistry while the game keeps ticking. The files are read
+// on a ThreadPool of their own, so the framework finds them in the OS cache; creating a sprite,
+// decoding included, has to go through the framework on the main thread, so Pump creates them
+// there a few at a time within a budget of framework ticks, in the order they were requested. Only
+// the reads are parallel. The handle of every sprite is written to
+// where its request said, and the reference taken by loading it is the requester's.
+class AssetLoader {
+    struct Request {
+        std::string path;
+        AssetGroup group;
+        SpriteHandle* handle;
+    };
+
+    AssetRegistry& assets;
+    std::vector<Request> requests;
+    // Set once the file of the request with the same index has been read.
+    std::unique_ptr<std::atomic<bool>[]> read;
+    size_t pending[ASSET_GROUP_COUNT] = {};
+    // Next request to create a sprite for.
+    size_t next = 0;
+    std::thread reader;
+    std::atomic<bool> cancelled = false;
+
+    // Reads the file through. Files that can't be read are left to the framework to report.
+    static void Prefetch(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+#if !defined(_WINDOWS)
+        if (!file)
+            file.open(getHeadlessDataDirectory() + path, std::ios::binary);
+#endif
+
+        char buffer[64 * 1024];
+        while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {}
+    }
+
+    void Create(Request& request) {
+        *request.handle = assets.Load(request.path);
+        pending[request.group]--;
+        next++;
+    }
+
+public:
+    explicit AssetLoader(AssetRegistry& assets) : assets(assets) {}
+
+    ~AssetLoader() {
+        Stop();
+    }
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // param: handle : where the handle goes once the sprite is loaded, must outlive the loader.
+    void Request(const std::string& path, AssetGroup group, SpriteHandle& handle) {
+        requests.push_back({ path, group, &handle });
+        pending[group]++;
+    }
+
+    // Starts reading the requested files in the background.
+    // param: threadCount : reading threads, 0 for one per hardware thread.
+    void Start(unsigned int threadCount = 0) {
+        read = std::make_unique<std::atomic<bool>[]>(requests.size());
+        reader = std::thread([this, threadCount] {
+            ThreadPool pool(threadCount);
+            pool.ParallelFor(requests.size(), 1, [this](size_t begin, size_t end) {
+                for (size_t i = begin; i < end; i++) {
+                    if (!cancelled.load(std::memory_order_relaxed))
+                        Prefetch(requests[i].path);
+                    read[i].store(true, std::memory_order_release);
+                }
+            });
+        });
+    }
+
+    // Creates the sprites whose files have been read, until one isn't or budget runs out. Always
+    // creates at least one if it can.
+    // param: budget : milliseconds on the framework's clock, getTickCount.
+    void Pump(unsigned int budget) {
+        unsigned int start = getTickCount();
+        while (next < requests.size() && read && read[next].load(std::memory_order_acquire)) {
+            Create(requests[next]);
+            if (getTickCount() - start >= budget)
+                break;
+        }
+        if (Done())
+            Stop();
+    }
+
+    // Creates every sprite left right away, the files not read yet are left to the framework.
+    void Finish() {
+        Stop();
+        while (next < requests.size())
+            Create(requests[next]);
+    }
+
+    // Stops reading, a read in progress is finished first. Sprites not created yet can still be
+    // created with Finish.
+    void Stop() {
+        if (!reader.joinable())
+            return;
+
+        cancelled = true;
+        reader.join();
+    }
+
+    bool Ready(AssetGroup group) const {
+        return pending[group] == 0;
+    }
+
+    bool Done() const {
+        return next == requests.size();
+    }
+
+    // return : percentage of the requested sprites created.
+    int Progress() const {
+        return requests.empty() ? 100 : (int)(next * 100 / requests.size());
+    }
+};
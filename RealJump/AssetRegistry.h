@@ -0,0 +1,147 @@
+#pragma once
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "MySprite.h"
+
+// Lightweight reference to a sprite owned by the AssetRegistry, cheap to copy into entity arrays.
+struct SpriteHandle {
+    static constexpr unsigned int invalidIndex = (unsigned int)-1;
+
+    unsigned int index = invalidIndex;
+
+    bool IsValid() const {
+        return index != invalidIndex;
+    }
+
+    bool operator==(const SpriteHandle& other) const {
+        return index == other.index;
+    }
+};
+
+struct AssetStats {
+    // Load calls, split into ones served by a resident sprite (hits) and ones that decoded the file (misses).
+    size_t loadCount = 0;
+    size_t hitCount = 0;
+    size_t missCount = 0;
+    size_t unloadCount = 0;
+    size_t residentCount = 0;
+    // Estimated as 32-bit RGBA pixels.
+    size_t bytesResident = 0;
+};
+
+// Owns every sprite the game uses. Sprites are keyed by path, so loading the same file twice returns
+// the same handle and bumps its reference count instead of decoding the file again. A sprite is
+// destroyed once every Load of it has been matched by an Unload.
+class AssetRegistry {
+    struct Entry {
+        std::string path;
+        MySprite* sprite = nullptr;
+        int referenceCount = 0;
+    };
+
+    std::vector<Entry> entries;
+    std::unordered_map<std::string, unsigned int> indexByPath;
+    std::vector<unsigned int> freeIndices;
+    AssetStats stats;
+
+    static size_t SpriteBytes(const MySprite* sprite) {
+        return (size_t)sprite->size.x * (size_t)sprite->size.y * 4;
+    }
+
+    void Destroy(unsigned int index) {
+        Entry& entry = entries[index];
+
+        stats.unloadCount++;
+        stats.residentCount--;
+        stats.bytesResident -= SpriteBytes(entry.sprite);
+
+        indexByPath.erase(entry.path);
+        delete entry.sprite;
+        entry = Entry();
+        freeIndices.push_back(index);
+    }
+
+public:
+    AssetRegistry() = default;
+    AssetRegistry(const AssetRegistry&) = delete;
+    AssetRegistry& operator=(const AssetRegistry&) = delete;
+
+    ~AssetRegistry() {
+        UnloadAll();
+    }
+
+    SpriteHandle Load(const std::string& path) {
+        stats.loadCount++;
+
+        auto found = indexByPath.find(path);
+        if (found != indexByPath.end()) {
+            stats.hitCount++;
+            entries[found->second].referenceCount++;
+            return SpriteHandle{ found->second };
+        }
+
+        stats.missCount++;
+
+        unsigned int index;
+        if (freeIndices.empty()) {
+            index = (unsigned int)entries.size();
+            entries.emplace_back();
+        }
+        else {
+            index = freeIndices.back();
+            freeIndices.pop_back();
+        }
+
+        Entry& entry = entries[index];
+        entry.path = path;
+        entry.sprite = new MySprite(path.c_str());
+        entry.referenceCount = 1;
+        indexByPath[path] = index;
+
+        stats.residentCount++;
+        stats.bytesResident += SpriteBytes(entry.sprite);
+
+        return SpriteHandle{ index };
+    }
+
+    // Drops one reference, the sprite is destroyed when the last one goes.
+    void Unload(SpriteHandle handle) {
+        if (!handle.IsValid() || handle.index >= entries.size() || !entries[handle.index].sprite)
+            return;
+
+        if (--entries[handle.index].referenceCount <= 0)
+            Destroy(handle.index);
+    }
+
+    // Destroys every resident sprite regardless of outstanding references.
+    void UnloadAll() {
+        for (unsigned int i = 0; i < entries.size(); i++) {
+            if (entries[i].sprite)
+                Destroy(i);
+        }
+    }
+
+    MySprite* operator[](SpriteHandle handle) const {
+        return entries[handle.index].sprite;
+    }
+
+    int ReferenceCount(SpriteHandle handle) const {
+        return entries[handle.index].referenceCount;
+    }
+
+    std::vector<SpriteHandle> ResidentHandles() const {
+        std::vector<SpriteHandle> handles;
+        for (unsigned int i = 0; i < entries.size(); i++) {
+            if (entries[i].sprite)
+                handles.push_back(SpriteHandle{ i });
+        }
+        return handles;
+    }
+
+    const AssetStats& Stats() const {
+        return stats;
+    }
+};
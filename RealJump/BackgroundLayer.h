@@ -0,0 +1,57 @@
+#pragma once
+
+#include "DrawList.h"
+
+// Window-sized layer covered by a repeating tile and scrolled vertically by an offset. The layout is
+// composed once per window size and every frame is a single wrap-around tiled blit, so the per-frame
+// cost doesn't grow with the resolution or the number of tiles covering the window.
+class BackgroundLayer {
+    MySprite* tile = nullptr;
+    int width = 0;
+    int height = 0;
+    // Vertical scroll offset, kept within one tile height so it never loses float precision.
+    float offset = 0;
+    float previousOffset = 0;
+
+public:
+    void Compose(MySprite* backgroundTile, Dimension windowSize) {
+        tile = backgroundTile;
+        width = (int)windowSize.x;
+        height = (int)windowSize.y;
+        offset = previousOffset = 0;
+    }
+
+    float Offset() const {
+        return offset;
+    }
+
+    float PreviousOffset() const {
+        return previousOffset;
+    }
+
+    void Restore(float savedOffset, float savedPreviousOffset) {
+        offset = savedOffset;
+        previousOffset = savedPreviousOffset;
+    }
+
+    void StorePreviousOffset() {
+        previousOffset = offset;
+    }
+
+    void Scroll(float dy) {
+        offset += dy;
+
+        float tileHeight = tile->size.y;
+        if (offset >= tileHeight) {
+            // Wrap both offsets by the same amount so rendering still interpolates between them.
+            offset -= tileHeight;
+            previousOffset -= tileHeight;
+        }
+    }
+
+    // param: alpha : fraction of a simulation step elapsed since the last one.
+    void Render(float alpha, DrawList& drawList) const {
+        float renderOffset = previousOffset + (offset - previousOffset) * alpha;
+        drawList.AddTiled(tile, 0, (int)renderOffset, width, height);
+    }
+};
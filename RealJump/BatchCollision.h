@@ -0,0 +1,263 @@
+#pragma once
+
+#include <bit>
+#include <cstddef>
+#include <vector>
+
+#if defined(__AVX__)
+#include <immintrin.h>
+#define REALJUMP_COLLISION_AVX
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define REALJUMP_COLLISION_SSE
+#endif
+
+enum Collision {
+    NONE,
+    TOP,
+    OTHER,
+};
+
+struct Box {
+    float x = 0;
+    float y = 0;
+    float width = 0;
+    float height = 0;
+};
+
+// Boxes laid out as parallel arrays, the way EntityStore keeps them.
+struct BoxArrays {
+    const float* x;
+    const float* y;
+    const float* width;
+    const float* height;
+};
+
+struct Contact {
+    unsigned int index;
+    Collision collision;
+};
+
+// Tests one box against many in a single pass. Each kernel is written once against a set of lanes
+// and instantiated for AVX (8 boxes per step) or SSE (4), whichever the compiler targets. Without
+// either, and for the tail of every batch, the boxes are tested one by one with early outs.
+// Boxes are either the first count entries of the arrays or, when indices is given, the count entries
+// it lists. Hits are reported by their index into the arrays, in the order they were tested.
+class BatchCollision {
+public:
+    // No vector unit: one lane tested with the pairwise early-out tests, which beat running the
+    // lane kernels one box at a time.
+    struct ScalarLanes {
+        static constexpr int count = 1;
+    };
+
+#if defined(REALJUMP_COLLISION_SSE) || defined(REALJUMP_COLLISION_AVX)
+    struct SseLanes {
+        static constexpr int count = 4;
+        using Value = __m128;
+        using Mask = __m128;
+
+        static Value Load(const float* values) { return _mm_loadu_ps(values); }
+        static Value Gather(const float* values, const unsigned int* indices) {
+            return _mm_set_ps(values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+        }
+        static Value Splat(float value) { return _mm_set1_ps(value); }
+        static Value Add(Value a, Value b) { return _mm_add_ps(a, b); }
+        static Mask Less(Value a, Value b) { return _mm_cmplt_ps(a, b); }
+        static Mask LessEqual(Value a, Value b) { return _mm_cmple_ps(a, b); }
+        static Mask And(Mask a, Mask b) { return _mm_and_ps(a, b); }
+        static unsigned int Bits(Mask mask) { return (unsigned int)_mm_movemask_ps(mask); }
+    };
+#endif
+
+#if defined(REALJUMP_COLLISION_AVX)
+    struct AvxLanes {
+        static constexpr int count = 8;
+        using Value = __m256;
+        using Mask = __m256;
+
+        static Value Load(const float* values) { return _mm256_loadu_ps(values); }
+        static Value Gather(const float* values, const unsigned int* indices) {
+            return _mm256_set_ps(values[indices[7]], values[indices[6]], values[indices[5]], values[indices[4]],
+                values[indices[3]], values[indices[2]], values[indices[1]], values[indices[0]]);
+        }
+        static Value Splat(float value) { return _mm256_set1_ps(value); }
+        static Value Add(Value a, Value b) { return _mm256_add_ps(a, b); }
+        static Mask Less(Value a, Value b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+        static Mask LessEqual(Value a, Value b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+        static Mask And(Mask a, Mask b) { return _mm256_and_ps(a, b); }
+        static unsigned int Bits(Mask mask) { return (unsigned int)_mm256_movemask_ps(mask); }
+    };
+
+    using DefaultLanes = AvxLanes;
+#elif defined(REALJUMP_COLLISION_SSE)
+    using DefaultLanes = SseLanes;
+#else
+    using DefaultLanes = ScalarLanes;
+#endif
+
+private:
+    // Edges of the box every candidate is tested against, splatted across the lanes.
+    template <typename Lanes>
+    struct Edges {
+        typename Lanes::Value left, top, right, bottom;
+
+        explicit Edges(Box box)
+            : left(Lanes::Splat(box.x)), top(Lanes::Splat(box.y)),
+            right(Lanes::Splat(box.x + box.width)), bottom(Lanes::Splat(box.y + box.height)) {}
+    };
+
+    // One step's worth of candidate boxes.
+    template <typename Lanes>
+    struct Candidates {
+        typename Lanes::Value left, top, right, bottom;
+
+        Candidates(BoxArrays boxes, const unsigned int* indices, size_t i) {
+            typename Lanes::Value width, height;
+            if (indices) {
+                left = Lanes::Gather(boxes.x, indices + i);
+                top = Lanes::Gather(boxes.y, indices + i);
+                width = Lanes::Gather(boxes.width, indices + i);
+                height = Lanes::Gather(boxes.height, indices + i);
+            }
+            else {
+                left = Lanes::Load(boxes.x + i);
+                top = Lanes::Load(boxes.y + i);
+                width = Lanes::Load(boxes.width + i);
+                height = Lanes::Load(boxes.height + i);
+            }
+            right = Lanes::Add(left, width);
+            bottom = Lanes::Add(top, height);
+        }
+    };
+
+    // Overlap including touching edges.
+    template <typename Lanes>
+    static typename Lanes::Mask Overlap(const Edges<Lanes>& box, const Candidates<Lanes>& other) {
+        return Lanes::And(
+            Lanes::And(Lanes::LessEqual(other.top, box.bottom), Lanes::LessEqual(box.top, other.bottom)),
+            Lanes::And(Lanes::LessEqual(other.left, box.right), Lanes::LessEqual(box.left, other.right)));
+    }
+
+    static unsigned int Index(const unsigned int* indices, size_t i) {
+        return indices ? indices[i] : (unsigned int)i;
+    }
+
+    // return : index of the first candidate left untested.
+    template <typename Lanes>
+    static size_t OverlapsFrom(Box box, BoxArrays boxes, const unsigned int* indices, size_t i, size_t count,
+        std::vector<unsigned int>& hits) {
+        Edges<Lanes> edges(box);
+
+        for (; i + Lanes::count <= count; i += Lanes::count) {
+            for (unsigned int bits = Lanes::Bits(Overlap(edges, Candidates<Lanes>(boxes, indices, i))); bits; bits &= bits - 1)
+                hits.push_back(Index(indices, i + std::countr_zero(bits)));
+        }
+        return i;
+    }
+
+    template <typename Lanes>
+    static size_t ContactsFrom(Box box, bool falling, BoxArrays boxes, const unsigned int* indices, size_t i,
+        size_t count, std::vector<Contact>& contacts) {
+        Edges<Lanes> edges(box);
+        // A falling box stomps the other one unless its bottom has gone more than 5 past the other's bottom.
+        typename Lanes::Value landingDepth = Lanes::Splat(box.y + box.height - 5);
+
+        for (; i + Lanes::count <= count; i += Lanes::count) {
+            Candidates<Lanes> other(boxes, indices, i);
+            unsigned int bits = Lanes::Bits(Overlap(edges, other));
+            unsigned int topBits = falling ? Lanes::Bits(Lanes::LessEqual(landingDepth, other.bottom)) : 0;
+
+            for (; bits; bits &= bits - 1) {
+                int lane = std::countr_zero(bits);
+                contacts.push_back(Contact{ Index(indices, i + lane), (topBits >> lane) & 1 ? TOP : OTHER });
+            }
+        }
+        return i;
+    }
+
+    template <typename Lanes>
+    static size_t LandingsFrom(Box box, BoxArrays boxes, const unsigned int* indices, size_t i, size_t count,
+        std::vector<unsigned int>& hits) {
+        Edges<Lanes> edges(box);
+
+        for (; i + Lanes::count <= count; i += Lanes::count) {
+            Candidates<Lanes> other(boxes, indices, i);
+            typename Lanes::Mask inside = Lanes::And(
+                Lanes::And(Lanes::Less(other.top, edges.bottom), Lanes::Less(edges.top, other.top)),
+                Lanes::And(Lanes::Less(other.left, edges.right), Lanes::Less(edges.left, other.right)));
+
+            for (unsigned int bits = Lanes::Bits(inside); bits; bits &= bits - 1)
+                hits.push_back(Index(indices, i + std::countr_zero(bits)));
+        }
+        return i;
+    }
+
+    // The tests above one box at a time, with the same arithmetic so both agree exactly.
+    static bool OverlapsOne(Box box, BoxArrays boxes, unsigned int other) {
+        return boxes.y[other] <= box.y + box.height && box.y <= boxes.y[other] + boxes.height[other] &&
+            boxes.x[other] <= box.x + box.width && box.x <= boxes.x[other] + boxes.width[other];
+    }
+
+    static void OverlapsPairwise(Box box, BoxArrays boxes, const unsigned int* indices, size_t i, size_t count,
+        std::vector<unsigned int>& hits) {
+        for (; i < count; i++) {
+            if (OverlapsOne(box, boxes, Index(indices, i)))
+                hits.push_back(Index(indices, i));
+        }
+    }
+
+    static void ContactsPairwise(Box box, bool falling, BoxArrays boxes, const unsigned int* indices, size_t i,
+        size_t count, std::vector<Contact>& contacts) {
+        float landingDepth = box.y + box.height - 5;
+        for (; i < count; i++) {
+            unsigned int other = Index(indices, i);
+            if (OverlapsOne(box, boxes, other)) {
+                bool top = falling && landingDepth <= boxes.y[other] + boxes.height[other];
+                contacts.push_back(Contact{ other, top ? TOP : OTHER });
+            }
+        }
+    }
+
+    static void LandingsPairwise(Box box, BoxArrays boxes, const unsigned int* indices, size_t i, size_t count,
+        std::vector<unsigned int>& hits) {
+        for (; i < count; i++) {
+            unsigned int other = Index(indices, i);
+            if (boxes.y[other] < box.y + box.height && box.y < boxes.y[other] &&
+                boxes.x[other] < box.x + box.width && box.x < boxes.x[other] + boxes.width[other])
+                hits.push_back(other);
+        }
+    }
+
+public:
+    // Appends the boxes overlapping box, touching edges included.
+    template <typename Lanes = DefaultLanes>
+    static void FindOverlaps(Box box, BoxArrays boxes, const unsigned int* indices, size_t count,
+        std::vector<unsigned int>& hits) {
+        size_t i = 0;
+        if constexpr (Lanes::count > 1)
+            i = OverlapsFrom<Lanes>(box, boxes, indices, 0, count, hits);
+        OverlapsPairwise(box, boxes, indices, i, count, hits);
+    }
+
+    // Appends the boxes overlapping box, classified as TOP when box is falling onto them and OTHER otherwise.
+    template <typename Lanes = DefaultLanes>
+    static void FindContacts(Box box, bool falling, BoxArrays boxes, const unsigned int* indices, size_t count,
+        std::vector<Contact>& contacts) {
+        size_t i = 0;
+        if constexpr (Lanes::count > 1)
+            i = ContactsFrom<Lanes>(box, falling, boxes, indices, 0, count, contacts);
+        ContactsPairwise(box, falling, boxes, indices, i, count, contacts);
+    }
+
+    // Appends the boxes whose top edge lies strictly between box's top and bottom edges, as when
+    // landing on a platform.
+    template <typename Lanes = DefaultLanes>
+    static void FindLandings(Box box, BoxArrays boxes, const unsigned int* indices, size_t count,
+        std::vector<unsigned int>& hits) {
+        size_t i = 0;
+        if constexpr (Lanes::count > 1)
+            i = LandingsFrom<Lanes>(box, boxes, indices, 0, count, hits);
+        LandingsPairwise(box, boxes, indices, i, count, hits);
+    }
+};
@@ -0,0 +1,21 @@
+#pragma once
+
+// Vertical view onto the world. Entities keep world coordinates, y growing downwards as on the
+// screen, and only drawing subtracts the camera's top edge, so following the player moves this
+// one value instead of every entity.
+struct Camera {
+    // World y of the top edge of the window.
+    float top = 0;
+    // Top at the start of the current simulation step, used to interpolate rendering.
+    float previousTop = 0;
+
+    // return : world y of the bottom edge of a window height high.
+    float Bottom(float height) const {
+        return top + height;
+    }
+
+    // param: alpha : fraction of a simulation step elapsed since the last one.
+    float RenderTop(float alpha) const {
+        return previousTop + (top - previousTop) * alpha;
+    }
+};
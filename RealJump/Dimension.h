@@ -0,0 +1,31 @@
+#pragma once
+
+struct Dimension {
+    float x;
+    float y;
+
+    Dimension() : x(0), y(0) {}
+    Dimension(float x, float y) : x(x), y(y) {}
+
+    // Addition.
+    Dimension operator+(const Dimension& other) const {
+        return Dimension(x + other.x, y + other.y);
+    }
+
+    // Subtraction.
+    Dimension operator-(const Dimension& other) const {
+        return Dimension(x - other.x, y - other.y);
+    }
+
+    // Scalar multiplication.
+    Dimension operator*(float scalar) const {
+        return Dimension(x * scalar, y * scalar);
+    }
+
+    // In-place scalar division.
+    Dimension& operator/=(float scalar) {
+        x /= scalar;
+        y /= scalar;
+        return *this;
+    }
+};
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "MySprite.h"
+
+#if !defined(_WINDOWS)
+    #include "FrameworkHeadless.h"
+#endif
+
+// Draws are submitted one layer after another in this order, whatever order they were recorded in.
+enum DrawLayer {
+    LAYER_BACKGROUND,
+    LAYER_OBJECTS,
+    LAYER_ENEMIES,
+    LAYER_PROJECTILES,
+    LAYER_PLAYER,
+    LAYER_HUD
+};
+
+struct DrawCommand {
+    MySprite* sprite;
+    int x;
+    int y;
+    // Non-zero for tiled fills of the rectangle (0, 0, width, height), see DrawList::AddTiled.
+    int width;
+    int height;
+    DrawLayer layer;
+};
+
+// Draw calls recorded by the render pass, submitted to the framework in one go.
+// Draws that miss the viewport are dropped as they are recorded. Submit sorts the rest by layer,
+// then by atlas page and sprite, so draws of the same sprite go out back to back and consecutive
+// draws of sprites packed into the same atlas page are submitted as one batch. Within a layer draws
+// don't keep their recorded order, so overlapping sprites belong in different layers.
+class DrawList {
+    // Frames up to this many draws are insertion sorted. Layers are recorded one after another, so
+    // only the sprites within a layer are out of order, and that is cheaper than a full sort.
+    static constexpr size_t insertionSortLimit = 64;
+
+    std::vector<DrawCommand> commands;
+    size_t lastBatchCount = 0;
+    // 0 until SetViewport, nothing is culled then.
+    int viewportWidth = 0;
+    int viewportHeight = 0;
+    size_t culledCount = 0;
+    size_t lastSubmittedCount = 0;
+    size_t lastCulledCount = 0;
+    // Sort keys of the commands, and the commands in sorted order, kept between frames so Submit
+    // doesn't allocate.
+    std::vector<uint64_t> keys;
+    std::vector<DrawCommand> sorted;
+#if !defined(_WINDOWS)
+    std::vector<SpriteDraw> batch;
+#endif
+
+    void SubmitTiled(const DrawCommand& command) {
+#if defined(_WINDOWS)
+        // The prebuilt framework can't wrap a texture, draw the tiles that intersect the rectangle instead.
+        int tileWidth = (int)command.sprite->size.x;
+        int tileHeight = (int)command.sprite->size.y;
+        int startX = command.x % tileWidth - (command.x % tileWidth > 0 ? tileWidth : 0);
+        int startY = command.y % tileHeight - (command.y % tileHeight > 0 ? tileHeight : 0);
+
+        for (int y = startY; y < command.height; y += tileHeight) {
+            for (int x = startX; x < command.width; x += tileWidth)
+                command.sprite->Draw(x, y);
+        }
+#else
+        drawSpriteTiled(command.sprite->sprite, command.x, command.y, command.width, command.height);
+#endif
+    }
+
+    // Layer, atlas page and sprite id packed above the recorded position, so sorting is an integer
+    // sort and draws that tie keep their recorded order. Ids only keep their low 16 bits, sprites
+    // created 65536 apart are merely not grouped.
+    static uint64_t SortKey(const DrawCommand& command, size_t index) {
+        return (uint64_t)command.layer << 61 | (uint64_t)((command.sprite->atlasPage + 1) & 0x1FFF) << 48 |
+            (uint64_t)(command.sprite->id & 0xFFFF) << 32 | (uint32_t)index;
+    }
+
+    void Sort() {
+        keys.clear();
+        for (size_t i = 0; i < commands.size(); i++)
+            keys.push_back(SortKey(commands[i], i));
+
+        if (keys.size() > insertionSortLimit) {
+            std::sort(keys.begin(), keys.end());
+        }
+        else {
+            for (size_t i = 1; i < keys.size(); i++) {
+                uint64_t key = keys[i];
+                size_t j = i;
+                for (; j > 0 && keys[j - 1] > key; j--)
+                    keys[j] = keys[j - 1];
+                keys[j] = key;
+            }
+        }
+
+        sorted.clear();
+        for (uint64_t key : keys)
+            sorted.push_back(commands[(uint32_t)key]);
+        commands.swap(sorted);
+    }
+
+    void SubmitBatch(size_t begin, size_t end) {
+#if defined(_WINDOWS)
+        // The prebuilt framework has no batch entry point.
+        for (size_t i = begin; i < end; i++)
+            commands[i].sprite->Draw(commands[i].x, commands[i].y);
+#else
+        batch.clear();
+        for (size_t i = begin; i < end; i++)
+            batch.push_back({ commands[i].sprite->sprite, commands[i].x, commands[i].y });
+        drawSpriteBatch(batch.data(), (int)batch.size());
+#endif
+    }
+
+public:
+    // Draws entirely outside (0, 0, width, height) are culled from then on.
+    void SetViewport(int width, int height) {
+        viewportWidth = width;
+        viewportHeight = height;
+    }
+
+    void Add(MySprite* sprite, int x, int y, DrawLayer layer) {
+        if (viewportWidth && (x >= viewportWidth || y >= viewportHeight ||
+            x + (int)sprite->size.x <= 0 || y + (int)sprite->size.y <= 0)) {
+            culledCount++;
+            return;
+        }
+        commands.push_back({ sprite, x, y, 0, 0, layer });
+    }
+
+    // Appends prepared commands as they are, e.g. a cached run of text. They aren't culled.
+    void AddRun(const std::vector<DrawCommand>& run) {
+        commands.insert(commands.end(), run.begin(), run.end());
+    }
+
+    // Fills the rectangle (0, 0, width, height) with copies of the sprite, one of them at (offsetX, offsetY),
+    // under everything else.
+    void AddTiled(MySprite* sprite, int offsetX, int offsetY, int width, int height) {
+        commands.push_back({ sprite, offsetX, offsetY, width, height, LAYER_BACKGROUND });
+    }
+
+    void Submit() {
+        lastBatchCount = 0;
+        lastSubmittedCount = commands.size();
+        lastCulledCount = culledCount;
+        culledCount = 0;
+        Sort();
+
+        size_t begin = 0;
+        while (begin < commands.size()) {
+            if (commands[begin].width) {
+                SubmitTiled(commands[begin++]);
+                lastBatchCount++;
+                continue;
+            }
+
+            int page = commands[begin].sprite->atlasPage;
+            size_t end = begin + 1;
+
+            while (page >= 0 && end < commands.size() && commands[end].sprite->atlasPage == page && !commands[end].width)
+                end++;
+
+            SubmitBatch(begin, end);
+            lastBatchCount++;
+            begin = end;
+        }
+
+        commands.clear();
+    }
+
+    size_t Size() const {
+        return commands.size();
+    }
+
+    // Number of batches the last Submit was split into.
+    size_t LastBatchCount() const {
+        return lastBatchCount;
+    }
+
+    // Draws the last Submit sent to the framework, and the ones culled since the Submit before it.
+    size_t LastSubmittedCount() const {
+        return lastSubmittedCount;
+    }
+
+    size_t LastCulledCount() const {
+        return lastCulledCount;
+    }
+};
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+
+// Log-linear histogram of durations, in whatever unit they are added in: eight buckets per power of
+// two, so percentiles are within 12.5% of the exact value at a fixed 2 KB per histogram. Durations
+// under eight are counted exactly.
+class DurationHistogram {
+    static constexpr int subBuckets = 8;
+
+    std::array<uint32_t, 512> counts = {};
+    uint64_t count = 0;
+    uint64_t max = 0;
+
+    static int Bucket(uint64_t duration) {
+        if (duration < subBuckets)
+            return (int)duration;
+
+        int octave = std::bit_width(duration) - 1;
+        return (octave - 2) * subBuckets + (int)((duration >> (octave - 3)) & (subBuckets - 1));
+    }
+
+    // return : largest duration that falls into bucket.
+    static uint64_t UpperBound(int bucket) {
+        if (bucket < subBuckets)
+            return bucket;
+
+        int octave = bucket / subBuckets + 2;
+        return ((uint64_t)(subBuckets + bucket % subBuckets + 1) << (octave - 3)) - 1;
+    }
+
+public:
+    void Add(uint64_t duration) {
+        counts[Bucket(duration)]++;
+        count++;
+        max = std::max(max, duration);
+    }
+
+    void Clear() {
+        counts.fill(0);
+        count = 0;
+        max = 0;
+    }
+
+    uint64_t Count() const {
+        return count;
+    }
+
+    uint64_t Max() const {
+        return max;
+    }
+
+    // param: fraction : 0.5 for the median, 0.99 for the 99th percentile.
+    uint64_t Percentile(double fraction) const {
+        uint64_t rank = std::max<uint64_t>((uint64_t)(fraction * count + 0.5), 1);
+        uint64_t seen = 0;
+        for (int bucket = 0; bucket < (int)counts.size(); bucket++) {
+            seen += counts[bucket];
+            if (seen >= rank)
+                return std::min(UpperBound(bucket), max);
+        }
+        return max;
+    }
+};
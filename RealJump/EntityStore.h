@@ -0,0 +1,465 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "Animation.h"
+#include "AssetRegistry.h"
+#include "BatchCollision.h"
+#include "DrawList.h"
+#include "HeightOrder.h"
+#include "SpatialIndex.h"
+
+enum ObjectType {
+    DEFAULT,
+    JUMP,
+    JUMP_BOOST,
+    JETPACK
+};
+
+// Bits of the animation key of a JUMP_BOOST platform, whose spring is drawn from springAnimation.
+enum SpringPoseBit {
+    SPRING_SPRUNG = 1,
+    SPRING_KEY_COUNT = 2
+};
+
+// Sprite slots of the spring, in the order MyFramework loads them.
+enum SpringSprite {
+    SPRITE_SPRING_TENSIONED,
+    SPRITE_SPRING_UNTENSIONED,
+    SPRING_SPRITE_COUNT
+};
+
+// The spring stays tensioned until the player first bounces off it.
+constexpr AnimationTable<SPRING_KEY_COUNT> springAnimation = { {
+    AnimationClip{ SPRITE_SPRING_TENSIONED },
+    AnimationClip{ SPRITE_SPRING_UNTENSIONED }
+} };
+
+// Optional indices a store keeps in sync with its entities, combined with |.
+enum StoreIndex {
+    NO_INDEX = 0,
+    SPATIAL_INDEX = 1,
+    HEIGHT_ORDER = 2,
+};
+
+// Names an entity for as long as it lives, unlike its index, which changes when another entity is
+// removed. Once the entity is destroyed the handle stays invalid, even after its slot is reused.
+struct EntityHandle {
+    uint32_t slot = UINT32_MAX;
+    uint32_t generation = 0;
+};
+
+// Capacity of the game's stores unless GameOptions says otherwise, and so also of a snapshot.
+constexpr size_t defaultEntityCapacity = 1024;
+
+// The entities of a store as plain data of a fixed size, see EntityStore::Save. Sizes aren't kept,
+// they follow from the sprites. Holds as many entities as a store of the default capacity, so any
+// game with default options can be saved.
+struct StoreSnapshot {
+    static constexpr size_t capacity = defaultEntityCapacity;
+
+    unsigned int count;
+    uint32_t nextGeneration;
+    double indexOffset;
+    float indexMaxHeight;
+    float x[capacity];
+    float y[capacity];
+    float previousX[capacity];
+    float previousY[capacity];
+    ObjectType type[capacity];
+    SpriteHandle sprite[capacity];
+    uint8_t pose[capacity];
+    float directionX[capacity];
+    float directionY[capacity];
+    int cell[capacity];
+    unsigned int order[capacity];
+    uint32_t slot[capacity];
+    uint32_t generation[capacity];
+};
+
+// Entities of one kind kept as parallel arrays in world coordinates, so the cull and collision
+// passes are linear scans over contiguous memory. Destroy only marks an entity; Flush removes the
+// marked ones by moving the last entity into each freed place, so an index is only valid until the
+// next Flush. Anything kept across steps holds an EntityHandle instead.
+// All arrays, and every cell of the spatial index, are reserved up front for a fixed capacity, so
+// spawning and despawning never touch the heap; adding to a full store is refused instead.
+// A store can also keep its entities in a SpatialIndex, so collision passes can ask for the few
+// entities near a row instead of testing all of them, and in a HeightOrder, so the highest and
+// lowest entities are known without a scan. Keep them in sync by moving entities only through
+// Add, Destroy, Teleport and Shift.
+class EntityStore {
+    static constexpr uint32_t noIndex = UINT32_MAX;
+
+    const AssetRegistry* assets;
+    size_t capacity;
+    size_t highWaterMark = 0;
+    size_t rejectedCount = 0;
+    bool indexed;
+    bool ordered;
+    SpatialIndex index;
+    HeightOrder order;
+    // Key of the index cell each entity is in, only filled for indexed stores.
+    std::vector<int> cell;
+    // Handle slot of each entity, and whether it has been destroyed and waits for Flush.
+    std::vector<uint32_t> slot;
+    std::vector<uint8_t> destroyed;
+    // Per handle slot, the index of the entity in it, noIndex if free, and the generation of its
+    // handle. Generations come from one counter per store, so a handle never matches a later entity.
+    // Slots are added as needed, so there are only as many as entities were alive at once.
+    std::vector<uint32_t> slotIndex;
+    std::vector<uint32_t> slotGeneration;
+    std::vector<uint32_t> freeSlots;
+    uint32_t nextGeneration = 1;
+    std::vector<EntityHandle> destroyQueue;
+
+    template <typename Function>
+    void ForEachArray(Function function) {
+        function(x);
+        function(y);
+        function(previousX);
+        function(previousY);
+        function(width);
+        function(height);
+        function(type);
+        function(sprite);
+        function(pose);
+        function(directionX);
+        function(directionY);
+        function(cell);
+        function(slot);
+        function(destroyed);
+    }
+
+    // Removes a destroyed entity, which is out of the indices already.
+    void Remove(size_t removed) {
+        size_t last = Size() - 1;
+        if (last != removed && !destroyed[last]) {
+            if (indexed)
+                index.Rename((unsigned int)last, (unsigned int)removed, cell[last]);
+            if (ordered)
+                order.Rename((unsigned int)last, (unsigned int)removed, y);
+        }
+
+        slotIndex[slot[removed]] = noIndex;
+        freeSlots.push_back(slot[removed]);
+        ForEachArray([removed, last](auto& array) {
+            array[removed] = array[last];
+            array.pop_back();
+        });
+        if (last != removed)
+            slotIndex[slot[removed]] = (uint32_t)removed;
+    }
+
+public:
+    std::vector<float> x;
+    std::vector<float> y;
+    // Position at the start of the current simulation step, used to interpolate rendering.
+    std::vector<float> previousX;
+    std::vector<float> previousY;
+    // Cached sprite size, so collision tests don't have to go through the sprite.
+    std::vector<float> width;
+    std::vector<float> height;
+    std::vector<ObjectType> type;
+    std::vector<SpriteHandle> sprite;
+    // Animation key of each entity, for what it draws beyond its sprite. Only drawing depends on it,
+    // so it isn't part of the state hash.
+    std::vector<uint8_t> pose;
+    // Unit vector the entity travels along, only used by projectiles.
+    std::vector<float> directionX;
+    std::vector<float> directionY;
+
+    // Returned by Add when the store is full.
+    static constexpr size_t none = (size_t)-1;
+
+    // param: indices : StoreIndex flags.
+    EntityStore(const AssetRegistry& assets, size_t capacity, int indices = NO_INDEX)
+        : assets(&assets), capacity(capacity), indexed(indices & SPATIAL_INDEX), ordered(indices & HEIGHT_ORDER) {
+        ForEachArray([capacity](auto& array) { array.reserve(capacity); });
+        order.Reserve(capacity);
+        slotIndex.reserve(capacity);
+        slotGeneration.reserve(capacity);
+        freeSlots.reserve(capacity);
+        destroyQueue.reserve(capacity);
+        if (indexed)
+            index.Reserve(capacity);
+    }
+
+    size_t Size() const {
+        return x.size();
+    }
+
+    size_t Capacity() const {
+        return capacity;
+    }
+
+    bool Full() const {
+        return Size() >= capacity;
+    }
+
+    // Largest number of entities alive at once.
+    size_t HighWaterMark() const {
+        return highWaterMark;
+    }
+
+    // Number of Add calls refused because the store was full.
+    size_t RejectedCount() const {
+        return rejectedCount;
+    }
+
+    // return : index of the new entity, none if the store is full.
+    size_t Add(SpriteHandle entitySprite, Dimension position, ObjectType entityType = ObjectType::DEFAULT,
+        Dimension direction = Dimension()) {
+        if (Full()) {
+            rejectedCount++;
+            return none;
+        }
+
+        x.push_back(position.x);
+        y.push_back(position.y);
+        previousX.push_back(position.x);
+        previousY.push_back(position.y);
+        Dimension size = (*assets)[entitySprite]->size;
+        width.push_back(size.x);
+        height.push_back(size.y);
+        type.push_back(entityType);
+        sprite.push_back(entitySprite);
+        pose.push_back(0);
+        directionX.push_back(direction.x);
+        directionY.push_back(direction.y);
+        cell.push_back(indexed ? index.Insert((unsigned int)Size() - 1, position.y, size.y) : 0);
+        if (ordered)
+            order.Insert((unsigned int)Size() - 1, y);
+
+        uint32_t entitySlot;
+        if (freeSlots.empty()) {
+            entitySlot = (uint32_t)slotIndex.size();
+            slotIndex.push_back(0);
+            slotGeneration.push_back(0);
+        }
+        else {
+            entitySlot = freeSlots.back();
+            freeSlots.pop_back();
+        }
+        slotIndex[entitySlot] = (uint32_t)Size() - 1;
+        slotGeneration[entitySlot] = nextGeneration++;
+        slot.push_back(entitySlot);
+        destroyed.push_back(false);
+
+        highWaterMark = std::max(highWaterMark, Size());
+        return Size() - 1;
+    }
+
+    // Takes the entity out of queries and the height order right away and leaves removing it to
+    // Flush, so indices stay valid until then. Destroying an entity twice does nothing.
+    void Destroy(size_t entity) {
+        if (destroyed[entity])
+            return;
+
+        destroyed[entity] = true;
+        if (indexed)
+            index.Erase((unsigned int)entity, cell[entity]);
+        if (ordered)
+            order.Erase((unsigned int)entity, y);
+        destroyQueue.push_back(Handle(entity));
+    }
+
+    bool IsDestroyed(size_t entity) const {
+        return destroyed[entity];
+    }
+
+    // Removes the entities destroyed since the last Flush, in the order they were destroyed.
+    void Flush() {
+        for (EntityHandle handle : destroyQueue)
+            Remove(slotIndex[handle.slot]);
+        destroyQueue.clear();
+    }
+
+    EntityHandle Handle(size_t entity) const {
+        return EntityHandle{ slot[entity], slotGeneration[slot[entity]] };
+    }
+
+    // return : index of the entity handle names, none if it has been destroyed.
+    size_t Find(EntityHandle handle) const {
+        if (handle.slot >= slotIndex.size() || slotGeneration[handle.slot] != handle.generation)
+            return none;
+
+        uint32_t entity = slotIndex[handle.slot];
+        return entity == noIndex || destroyed[entity] ? none : entity;
+    }
+
+    void Clear() {
+        ForEachArray([](auto& array) { array.clear(); });
+        index.Clear();
+        order.Clear();
+        slotIndex.clear();
+        slotGeneration.clear();
+        freeSlots.clear();
+        destroyQueue.clear();
+    }
+
+    BoxArrays Boxes() const {
+        return BoxArrays{ x.data(), y.data(), width.data(), height.data() };
+    }
+
+    // return : index of the entity with the smallest y, none if the store is empty. Needs HEIGHT_ORDER.
+    size_t Highest() const {
+        return order.Empty() ? none : order.Highest();
+    }
+
+    // return : index of the entity with the largest y, none if the store is empty. Needs HEIGHT_ORDER.
+    size_t Lowest() const {
+        return order.Empty() ? none : order.Lowest();
+    }
+
+    Dimension Position(size_t index) const {
+        return Dimension(x[index], y[index]);
+    }
+
+    // Moves the entity without interpolating from its old position. Not for destroyed entities.
+    void Teleport(size_t entity, Dimension position) {
+        if (ordered)
+            order.Erase((unsigned int)entity, y);
+
+        x[entity] = previousX[entity] = position.x;
+        y[entity] = previousY[entity] = position.y;
+
+        if (ordered)
+            order.Insert((unsigned int)entity, y);
+
+        if (indexed) {
+            index.Erase((unsigned int)entity, cell[entity]);
+            cell[entity] = index.Insert((unsigned int)entity, position.y, height[entity]);
+        }
+    }
+
+    void StorePreviousPositions() {
+        previousX = x;
+        previousY = y;
+    }
+
+    // Moves every entity by dy, along with where it is drawn from, e.g. to bring world coordinates
+    // back near zero.
+    void Shift(float dy) {
+        for (float& entityY : y)
+            entityY += dy;
+        for (float& entityY : previousY)
+            entityY += dy;
+        index.Shift(dy);
+    }
+
+    // Appends the entities that may overlap the rows between top and bottom, every entity if
+    // the store isn't indexed. Candidates still need an exact overlap test.
+    void Query(float top, float bottom, std::vector<unsigned int>& candidates) const {
+        if (indexed) {
+            index.Query(top, bottom, candidates);
+            return;
+        }
+
+        for (size_t i = 0; i < Size(); i++) {
+            if (!destroyed[i])
+                candidates.push_back((unsigned int)i);
+        }
+    }
+
+    // Copies the entities, their handles and the state of the indices into snapshot, in the same
+    // places.
+    // return : false if there are more entities than a snapshot holds or some wait for Flush.
+    bool Save(StoreSnapshot& snapshot) const {
+        size_t count = Size();
+        if (count > StoreSnapshot::capacity || !destroyQueue.empty())
+            return false;
+
+        snapshot.count = (unsigned int)count;
+        snapshot.nextGeneration = nextGeneration;
+        snapshot.indexOffset = index.Offset();
+        snapshot.indexMaxHeight = index.MaxHeight();
+        std::copy_n(x.data(), count, snapshot.x);
+        std::copy_n(y.data(), count, snapshot.y);
+        std::copy_n(previousX.data(), count, snapshot.previousX);
+        std::copy_n(previousY.data(), count, snapshot.previousY);
+        std::copy_n(type.data(), count, snapshot.type);
+        std::copy_n(sprite.data(), count, snapshot.sprite);
+        std::copy_n(pose.data(), count, snapshot.pose);
+        std::copy_n(directionX.data(), count, snapshot.directionX);
+        std::copy_n(directionY.data(), count, snapshot.directionY);
+        std::copy_n(cell.data(), count, snapshot.cell);
+        if (ordered)
+            std::copy_n(order.Entries().data(), count, snapshot.order);
+        std::copy_n(slot.data(), count, snapshot.slot);
+        for (size_t i = 0; i < count; i++)
+            snapshot.generation[i] = slotGeneration[slot[i]];
+        return true;
+    }
+
+    // Replaces the entities with the ones saved in snapshot. Entities keep their places and handles
+    // and the indices their buckets and ties, so the store behaves exactly as the saved one did.
+    // return : false, leaving the store as it was, if the snapshot doesn't fit Capacity.
+    bool Restore(const StoreSnapshot& snapshot) {
+        size_t count = snapshot.count;
+        if (count > capacity)
+            return false;
+        for (size_t i = 0; i < count; i++) {
+            if (snapshot.slot[i] >= capacity)
+                return false;
+        }
+
+        x.assign(snapshot.x, snapshot.x + count);
+        y.assign(snapshot.y, snapshot.y + count);
+        previousX.assign(snapshot.previousX, snapshot.previousX + count);
+        previousY.assign(snapshot.previousY, snapshot.previousY + count);
+        type.assign(snapshot.type, snapshot.type + count);
+        sprite.assign(snapshot.sprite, snapshot.sprite + count);
+        pose.assign(snapshot.pose, snapshot.pose + count);
+        directionX.assign(snapshot.directionX, snapshot.directionX + count);
+        directionY.assign(snapshot.directionY, snapshot.directionY + count);
+        cell.assign(snapshot.cell, snapshot.cell + count);
+        slot.assign(snapshot.slot, snapshot.slot + count);
+        destroyed.assign(count, false);
+        destroyQueue.clear();
+
+        uint32_t slotCount = 0;
+        for (size_t i = 0; i < count; i++)
+            slotCount = std::max(slotCount, slot[i] + 1);
+        slotIndex.assign(slotCount, noIndex);
+        slotGeneration.assign(slotCount, 0);
+        for (size_t i = 0; i < count; i++) {
+            slotIndex[slot[i]] = (uint32_t)i;
+            slotGeneration[slot[i]] = snapshot.generation[i];
+        }
+        freeSlots.clear();
+        for (uint32_t i = slotCount; i-- > 0; ) {
+            if (slotIndex[i] == noIndex)
+                freeSlots.push_back(i);
+        }
+        nextGeneration = snapshot.nextGeneration;
+
+        width.resize(count);
+        height.resize(count);
+        for (size_t i = 0; i < count; i++) {
+            Dimension size = (*assets)[sprite[i]]->size;
+            width[i] = size.x;
+            height[i] = size.y;
+        }
+
+        index.Restore(snapshot.indexOffset, snapshot.indexMaxHeight);
+        if (indexed) {
+            for (size_t i = 0; i < count; i++)
+                index.InsertAt((unsigned int)i, cell[i]);
+        }
+        order.Assign(snapshot.order, ordered ? count : 0);
+        highWaterMark = std::max(highWaterMark, count);
+        return true;
+    }
+
+    // param: alpha : fraction of a simulation step elapsed since the last one.
+    // param: top : world y drawn at the top edge of the window.
+    void Render(float alpha, float top, DrawLayer layer, DrawList& drawList) const {
+        for (size_t i = 0; i < Size(); i++) {
+            drawList.Add((*assets)[sprite[i]],
+                previousX[i] + (x[i] - previousX[i]) * alpha,
+                previousY[i] + (y[i] - previousY[i]) * alpha - top, layer);
+        }
+    }
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <thread>
+
+#include "DrawList.h"
+
+// Runs frames on a thread of its own, one frame ahead of the caller: while the caller submits the
+// draw list of frame N, the worker simulates frame N + 1 and records it into the other list. The
+// two threads only meet in Wait, which hands the finished list over; anything else the worker needs
+// for a frame is written by the caller between Wait and Next, while the worker is idle, so frame
+// time tends towards the longer of simulation and submission rather than their sum. Every frame
+// is shown one Tick after it was simulated.
+class FramePipeline {
+    DrawList lists[2];
+    // List the caller submits, the worker records into the other one.
+    int front = 0;
+    std::function<bool(DrawList&)> frame;
+    std::thread worker;
+    std::atomic<unsigned int> requested = 0;
+    std::atomic<unsigned int> finished = 0;
+    std::atomic<bool> stopping = false;
+    // Result of the last finished frame, published by finished.
+    bool exitRequested = false;
+
+    void Run() {
+        unsigned int done = 0;
+        while (true) {
+            requested.wait(done, std::memory_order_acquire);
+            if (stopping.load(std::memory_order_acquire))
+                return;
+
+            exitRequested = frame(lists[1 - front]);
+            finished.store(++done, std::memory_order_release);
+            finished.notify_one();
+        }
+    }
+
+public:
+    ~FramePipeline() {
+        Stop();
+    }
+
+    // param: frameFunction : records one frame into the list it is given and returns true to exit.
+    void Start(std::function<bool(DrawList&)> frameFunction) {
+        Stop();
+
+        frame = std::move(frameFunction);
+        front = 0;
+        requested = 0;
+        finished = 0;
+        exitRequested = false;
+        stopping = false;
+        worker = std::thread(&FramePipeline::Run, this);
+    }
+
+    // Finishes the frame in flight and joins the worker.
+    void Stop() {
+        if (!worker.joinable())
+            return;
+
+        Wait();
+        stopping = true;
+        requested.fetch_add(1, std::memory_order_release);
+        requested.notify_one();
+        worker.join();
+    }
+
+    // See DrawList::SetViewport.
+    void SetViewport(int width, int height) {
+        for (DrawList& list : lists)
+            list.SetViewport(width, height);
+    }
+
+    bool IsRunning() const {
+        return worker.joinable();
+    }
+
+    // Waits until the frame in flight, if any, is finished. The worker is idle from here to Next.
+    // return : true if that frame asked to exit.
+    bool Wait() {
+        unsigned int target = requested.load(std::memory_order_relaxed);
+        while (true) {
+            unsigned int done = finished.load(std::memory_order_acquire);
+            if (done == target)
+                return exitRequested;
+            finished.wait(done, std::memory_order_acquire);
+        }
+    }
+
+    // Brings the list of the finished frame to the front and starts the next frame. Call after Wait.
+    void Next() {
+        front = 1 - front;
+        requested.fetch_add(1, std::memory_order_release);
+        requested.notify_one();
+    }
+
+    // List of the last finished frame, the caller's to submit until the next Wait.
+    DrawList& Front() {
+        return lists[front];
+    }
+};
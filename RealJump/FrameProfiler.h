@@ -0,0 +1,245 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include "AssetRegistry.h"
+#include "DrawList.h"
+#include "DurationHistogram.h"
+#include "HudText.h"
+#include "SpscQueue.h"
+
+// Phases of a Tick timed by the profiler. Simulation phases run once per step, render phases once
+// per frame; PHASE_TICK covers the whole Tick. PHASE_TICK and PHASE_SUBMIT always run on the main
+// thread, the others on the simulation thread when the game is pipelined.
+enum ProfilePhase {
+    PHASE_TICK,
+    PHASE_SCROLL,
+    PHASE_PROJECTILES,
+    PHASE_PLAYER,
+    PHASE_SPAWN,
+    PHASE_RENDER_BACKGROUND,
+    PHASE_RENDER_OBJECTS,
+    PHASE_RENDER_ENEMIES,
+    PHASE_RENDER_PROJECTILES,
+    PHASE_RENDER_PLAYER,
+    PHASE_RENDER_HUD,
+    PHASE_SUBMIT,
+    PHASE_COUNT
+};
+
+constexpr const char* profilePhaseNames[PHASE_COUNT] = {
+    "tick", "scroll", "projectiles", "player", "spawn", "render_background", "render_objects",
+    "render_enemies", "render_projectiles", "render_player", "render_hud", "submit",
+};
+
+// return : 0 for the phases timed on the main thread, 1 for the ones that may run on the simulation thread.
+constexpr int ProfileThread(ProfilePhase phase) {
+    return phase == PHASE_TICK || phase == PHASE_SUBMIT ? 0 : 1;
+}
+
+#if defined(REALJUMP_PROFILE)
+
+struct ProfileSample {
+    ProfilePhase phase;
+    // Nanoseconds since the profiler was created.
+    uint64_t start;
+    uint64_t duration;
+};
+
+// Per-phase frame timers. Timed scopes push samples into a lock-free ring, one per thread of
+// ProfileThread so every ring has a single producer, and Drain folds them into histograms once per
+// Tick, away from the timed code. When the simulation runs on a thread of its own, Drain and
+// RenderOverlay must not overlap; the pipelined game drains while its simulation thread is idle.
+// The timed code never waits on Drain: a sample that finds the ring full is dropped and counted
+// instead. Samples can be kept for export as CSV or as a Chrome trace (chrome://tracing, Perfetto).
+//
+// Build with REALJUMP_PROFILE to enable it; otherwise FrameProfiler is an empty stub and
+// PROFILE_SCOPE expands to nothing.
+class FrameProfiler {
+    using Clock = std::chrono::steady_clock;
+
+    // Samples kept for export, about 24 MB.
+    static constexpr size_t maxTraceSamples = 1 << 20;
+    // Frames between two refreshes of the overlay.
+    static constexpr unsigned int overlayInterval = 60;
+
+    Clock::time_point epoch = Clock::now();
+    SpscQueue<ProfileSample, 4096> rings[2];
+    std::atomic<size_t> ringDropped = 0;
+    DurationHistogram total[PHASE_COUNT];
+    // Samples since the overlay was last refreshed.
+    DurationHistogram recent[PHASE_COUNT];
+    bool tracing = false;
+    std::vector<ProfileSample> trace;
+    size_t traceDropped = 0;
+    unsigned int framesSinceOverlay = 0;
+    // p50, p95, p99 and max of every phase, in microseconds.
+    std::vector<TextRun> overlay;
+
+    static double Microseconds(uint64_t nanoseconds) {
+        return nanoseconds / 1000.0;
+    }
+
+public:
+    static constexpr bool enabled = true;
+
+    uint64_t Now() const {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - epoch).count();
+    }
+
+    void Record(ProfilePhase phase, uint64_t start, uint64_t end) {
+        if (!rings[ProfileThread(phase)].TryPush(ProfileSample{ phase, start, end - start }))
+            ringDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Keeps every drained sample from now on, for Export.
+    void StartTrace() {
+        tracing = true;
+        trace.reserve(maxTraceSamples);
+    }
+
+    void Drain() {
+        ProfileSample sample;
+        for (SpscQueue<ProfileSample, 4096>& ring : rings) {
+            while (ring.TryPop(sample)) {
+                total[sample.phase].Add(sample.duration);
+                recent[sample.phase].Add(sample.duration);
+
+                if (!tracing)
+                    continue;
+                if (trace.size() < maxTraceSamples)
+                    trace.push_back(sample);
+                else
+                    traceDropped++;
+            }
+        }
+    }
+
+    // Draws one row of p50, p95, p99 and max per phase, in microseconds and in ProfilePhase order,
+    // refreshed every overlayInterval frames.
+    void RenderOverlay(const GlyphSet& glyphs, const AssetRegistry& assets, DrawList& drawList) {
+        if (overlay.empty()) {
+            for (int phase = 0; phase < PHASE_COUNT; phase++) {
+                for (int column = 0; column < 4; column++)
+                    overlay.emplace_back(4 + column * 5 * glyphs.Advance(), 80 + phase * 32);
+            }
+        }
+
+        if (++framesSinceOverlay >= overlayInterval) {
+            framesSinceOverlay = 0;
+            for (int phase = 0; phase < PHASE_COUNT; phase++) {
+                const DurationHistogram& histogram = recent[phase];
+                uint64_t values[4] = { histogram.Percentile(0.5), histogram.Percentile(0.95),
+                    histogram.Percentile(0.99), histogram.Max() };
+                for (int column = 0; column < 4; column++)
+                    overlay[phase * 4 + column].SetNumber((int)(values[column] / 1000), glyphs, assets);
+                recent[phase].Clear();
+            }
+        }
+
+        for (const TextRun& run : overlay)
+            run.Render(drawList);
+    }
+
+    // Forgets the overlay layout, e.g. before the glyphs it points to are unloaded.
+    void ResetOverlay() {
+        overlay.clear();
+        framesSinceOverlay = 0;
+    }
+
+    void PrintSummary(std::ostream& stream) const {
+        stream << "profile (us):" << std::setw(14) << "count" << std::setw(10) << "p50" << std::setw(10) << "p95"
+            << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl << std::fixed << std::setprecision(2);
+        for (int phase = 0; phase < PHASE_COUNT; phase++) {
+            const DurationHistogram& histogram = total[phase];
+            stream << "  " << std::left << std::setw(19) << profilePhaseNames[phase] << std::right
+                << std::setw(6) << histogram.Count()
+                << std::setw(10) << Microseconds(histogram.Percentile(0.5))
+                << std::setw(10) << Microseconds(histogram.Percentile(0.95))
+                << std::setw(10) << Microseconds(histogram.Percentile(0.99))
+                << std::setw(10) << Microseconds(histogram.Max()) << std::endl;
+        }
+        stream << std::defaultfloat << "profile: " << ringDropped.load(std::memory_order_relaxed) << " samples dropped by the ring, "
+            << traceDropped << " by the trace" << std::endl;
+    }
+
+    // Writes the kept samples as a Chrome trace if path ends in .json, as CSV otherwise.
+    // return : false if the file can't be written.
+    bool Export(const std::string& path) const {
+        std::ofstream file(path, std::ios::trunc);
+        if (!file)
+            return false;
+
+        bool chrome = path.size() >= 5 && path.compare(path.size() - 5, 5, ".json") == 0;
+        file << std::fixed << std::setprecision(3);
+
+        if (chrome) {
+            file << "{\"displayTimeUnit\": \"ns\", \"traceEvents\": [";
+            for (size_t i = 0; i < trace.size(); i++) {
+                const ProfileSample& sample = trace[i];
+                file << (i ? ",\n" : "\n") << "{\"name\": \"" << profilePhaseNames[sample.phase]
+                    << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << ProfileThread(sample.phase) + 1
+                    << ", \"ts\": " << Microseconds(sample.start)
+                    << ", \"dur\": " << Microseconds(sample.duration) << "}";
+            }
+            file << "\n]}\n";
+        }
+        else {
+            file << "phase,start_us,duration_us\n";
+            for (const ProfileSample& sample : trace) {
+                file << profilePhaseNames[sample.phase] << "," << Microseconds(sample.start) << ","
+                    << Microseconds(sample.duration) << "\n";
+            }
+        }
+        return (bool)file;
+    }
+};
+
+// Times the enclosing scope as phase.
+class ProfileScope {
+    FrameProfiler& profiler;
+    ProfilePhase phase;
+    uint64_t start;
+
+public:
+    ProfileScope(FrameProfiler& profiler, ProfilePhase phase)
+        : profiler(profiler), phase(phase), start(profiler.Now()) {}
+
+    ~ProfileScope() {
+        profiler.Record(phase, start, profiler.Now());
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_(a, b)
+#define PROFILE_SCOPE(profiler, phase) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, phase)
+
+#else
+
+// Profiling is compiled out, every call below is empty.
+class FrameProfiler {
+public:
+    static constexpr bool enabled = false;
+
+    void StartTrace() {}
+    void Drain() {}
+    void RenderOverlay(const GlyphSet&, const AssetRegistry&, DrawList&) {}
+    void ResetOverlay() {}
+    void PrintSummary(std::ostream&) const {}
+    bool Export(const std::string&) const { return false; }
+};
+
+#define PROFILE_SCOPE(profiler, phase)
+
+#endif
@@ -0,0 +1,210 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "FrameworkHeadless.h"
+
+// Headless implementation of the Framework.h API used for benchmarking and
+// batch runs on hosts without the Windows framework DLL.
+
+class Sprite {
+public:
+    std::string path;
+    int width;
+    int height;
+    int slot;
+};
+
+namespace {
+    std::vector<Sprite*> spriteTable;
+    std::vector<int> freeSlots;
+    unsigned int spritesCreated = 0;
+    unsigned int spritesAlive = 0;
+
+    int screenWidth = 0;
+    int screenHeight = 0;
+
+    unsigned long long tickLimit = 0;
+    unsigned int tickStep = 1;
+    unsigned int virtualTime = 0;
+    unsigned long long ticks = 0;
+    unsigned long long drawCalls = 0;
+    unsigned long long batchCalls = 0;
+    double wallSeconds = 0;
+
+    std::string dataDirectory() {
+        if (const char* dir = std::getenv("REALJUMP_DATA_DIR"))
+            return dir;
+#ifdef REALJUMP_DATA_ROOT
+        return REALJUMP_DATA_ROOT;
+#else
+        return "";
+#endif
+    }
+
+    unsigned int readBigEndian(const unsigned char* bytes) {
+        return ((unsigned int)bytes[0] << 24) | ((unsigned int)bytes[1] << 16) |
+            ((unsigned int)bytes[2] << 8) | (unsigned int)bytes[3];
+    }
+
+    // Only the IHDR chunk is read, pixel data is never decoded.
+    bool readPngSize(const std::string& path, int& w, int& h) {
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        unsigned char header[24];
+
+        std::ifstream file(path, std::ios::binary);
+        if (!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return false;
+
+        if (std::memcmp(header, signature, sizeof(signature)) != 0 || std::memcmp(header + 12, "IHDR", 4) != 0)
+            return false;
+
+        w = readBigEndian(header + 16);
+        h = readBigEndian(header + 20);
+        return true;
+    }
+
+    unsigned long long readEnvironment(const char* name, unsigned long long fallback) {
+        const char* value = std::getenv(name);
+        return value ? std::strtoull(value, nullptr, 10) : fallback;
+    }
+}
+
+FRAMEWORK_API Sprite* createSprite(const char* path) {
+    int w, h;
+    if (!readPngSize(path, w, h) && !readPngSize(dataDirectory() + path, w, h)) {
+        std::cerr << "createSprite: failed to load " << path << std::endl;
+        return nullptr;
+    }
+
+    Sprite* sprite = new Sprite{ path, w, h, 0 };
+    if (freeSlots.empty()) {
+        sprite->slot = (int)spriteTable.size();
+        spriteTable.push_back(sprite);
+    }
+    else {
+        sprite->slot = freeSlots.back();
+        freeSlots.pop_back();
+        spriteTable[sprite->slot] = sprite;
+    }
+
+    spritesCreated++;
+    spritesAlive++;
+    return sprite;
+}
+
+FRAMEWORK_API void drawSprite(Sprite* s, int /*x*/, int /*y*/) {
+    if (s)
+        drawCalls++;
+}
+
+FRAMEWORK_API void drawSpriteBatch(const SpriteDraw* draws, int count) {
+    batchCalls++;
+    for (int i = 0; i < count; i++) {
+        if (draws[i].sprite)
+            drawCalls++;
+    }
+}
+
+FRAMEWORK_API void drawSpriteTiled(Sprite* s, int /*offsetX*/, int /*offsetY*/, int /*width*/, int /*height*/) {
+    if (s)
+        drawCalls++;
+}
+
+FRAMEWORK_API void getSpriteSize(Sprite* s, int& w, int& h) {
+    w = s ? s->width : 0;
+    h = s ? s->height : 0;
+}
+
+FRAMEWORK_API void setSpriteSize(Sprite* s, int w, int h) {
+    if (!s)
+        return;
+    s->width = w;
+    s->height = h;
+}
+
+FRAMEWORK_API void destroySprite(Sprite* s) {
+    if (!s)
+        return;
+    spriteTable[s->slot] = nullptr;
+    freeSlots.push_back(s->slot);
+    spritesAlive--;
+    delete s;
+}
+
+FRAMEWORK_API void drawTestBackground() {
+    drawCalls++;
+}
+
+FRAMEWORK_API void getScreenSize(int& w, int& h) {
+    w = screenWidth;
+    h = screenHeight;
+}
+
+FRAMEWORK_API unsigned int getTickCount() {
+    return virtualTime;
+}
+
+FRAMEWORK_API void showCursor(bool /*bShow*/) {}
+
+FRAMEWORK_API const char* getHeadlessDataDirectory() {
+    static const std::string directory = dataDirectory();
+    return directory.c_str();
+}
+
+FRAMEWORK_API void setHeadlessTickLimit(unsigned long long limit) {
+    tickLimit = limit;
+}
+
+FRAMEWORK_API void setHeadlessTickStep(unsigned int milliseconds) {
+    tickStep = milliseconds;
+}
+
+FRAMEWORK_API void getHeadlessStats(HeadlessStats& stats) {
+    stats.ticks = ticks;
+    stats.drawCalls = drawCalls;
+    stats.batchCalls = batchCalls;
+    stats.spritesCreated = spritesCreated;
+    stats.spritesAlive = spritesAlive;
+    stats.wallSeconds = wallSeconds;
+}
+
+FRAMEWORK_API int run(Framework* framework) {
+    tickLimit = readEnvironment("REALJUMP_TICKS", tickLimit);
+    tickStep = (unsigned int)readEnvironment("REALJUMP_TICK_MS", tickStep);
+
+    // Every run starts its clock and counters from zero, so several games can run in one process.
+    ticks = 0;
+    drawCalls = 0;
+    batchCalls = 0;
+    virtualTime = 0;
+
+    bool fullscreen = false;
+    framework->PreInit(screenWidth, screenHeight, fullscreen);
+
+    if (!framework->Init()) {
+        delete framework;
+        return 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    while (!tickLimit || ticks < tickLimit) {
+        ticks++;
+        if (framework->Tick())
+            break;
+        virtualTime += tickStep;
+    }
+    wallSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    framework->Close();
+    delete framework;
+
+    std::cerr << "headless: " << ticks << " ticks in " << wallSeconds << " s ("
+        << (wallSeconds > 0 ? ticks / wallSeconds : 0) << " ticks/s), "
+        << drawCalls << " draw calls in " << batchCalls << " batches, " << spritesAlive << " sprites still alive" << std::endl;
+    return 0;
+}
@@ -0,0 +1,48 @@
+#pragma once
+
+#include "Framework.h"
+
+// Extensions provided only by the headless backend (FrameworkHeadless.cpp).
+// The headless backend has no window, no GPU and no input devices. Sprites
+// are tracked in a table with their real sizes (read from the PNG header) and
+// getTickCount() is driven by a virtual clock that advances a fixed number
+// of milliseconds per Tick, so run() goes as fast as the CPU allows.
+//
+// Defaults can also be set through the environment:
+//   REALJUMP_TICKS    - number of ticks to run before run() returns (0 = unlimited).
+//   REALJUMP_TICK_MS  - virtual milliseconds per tick.
+//   REALJUMP_DATA_DIR - directory that relative sprite paths are resolved against.
+
+struct HeadlessStats {
+    unsigned long long ticks;
+    unsigned long long drawCalls;
+    unsigned long long batchCalls;
+    unsigned int spritesCreated;
+    unsigned int spritesAlive;
+    double wallSeconds;
+};
+
+// Stop run() after this many ticks (0 = run until Tick() returns true).
+FRAMEWORK_API void setHeadlessTickLimit(unsigned long long ticks);
+
+// Virtual milliseconds the clock advances per Tick.
+FRAMEWORK_API void setHeadlessTickStep(unsigned int milliseconds);
+
+// Directory relative sprite paths are resolved against when they aren't found as given.
+FRAMEWORK_API const char* getHeadlessDataDirectory();
+
+// Stats of the current or last run(); ticks, draw calls and the clock restart with every run().
+FRAMEWORK_API void getHeadlessStats(HeadlessStats& stats);
+
+struct SpriteDraw {
+    Sprite* sprite;
+    int x;
+    int y;
+};
+
+// Draws count sprites in one call, in order.
+FRAMEWORK_API void drawSpriteBatch(const SpriteDraw* draws, int count);
+
+// Fills the rectangle (0, 0, width, height) with copies of the sprite in one call, wrapping around
+// so that one copy lands at (offsetX, offsetY).
+FRAMEWORK_API void drawSpriteTiled(Sprite* s, int offsetX, int offsetY, int width, int height);
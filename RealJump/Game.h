@@ -0,0 +1,891 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "AssetLoader.h"
+#include "AssetRegistry.h"
+#include "BackgroundLayer.h"
+#include "BatchCollision.h"
+#include "Camera.h"
+#include "DurationHistogram.h"
+#include "EntityStore.h"
+#include "FramePipeline.h"
+#include "FrameProfiler.h"
+#include "HudText.h"
+#include "InputLog.h"
+#include "InputQueue.h"
+#include "LevelGenerator.h"
+#include "Player.h"
+#include "Random.h"
+#include "TextureAtlas.h"
+#include "Framework.h"
+
+// Simulation advances in fixed steps of this many milliseconds, independent of how often Tick is called.
+// Velocities are in pixels per millisecond and timers count milliseconds.
+const unsigned int simulationStep = 4;
+
+// Upper bound on catch-up steps per Tick, so a long stall doesn't snowball into ever longer frames.
+const unsigned int maxSimulationSteps = 25;
+
+// Milliseconds per Tick spent creating sprites while assets stream in, so the loading screen keeps drawing.
+const unsigned int loadingBudget = 8;
+
+// Once the camera is this far above the origin the whole world is moved back down by as much, so
+// world coordinates stay small enough for floats to keep sub-pixel precision. A power of two, so
+// moving is exact.
+const float rebaseDistance = 16384;
+
+struct GameOptions {
+    // Headless runs can skip the render pass entirely.
+    bool renderingEnabled = true;
+    // Capacity of each of the objects, enemies and projectiles stores. A game whose stores hold more
+    // than StoreSnapshot::capacity entities can't be saved.
+    size_t entityCapacity = defaultEntityCapacity;
+    // Print entity store usage when the game closes.
+    bool printStats = false;
+    // Seed of the level generator, taken from the clock unless hasSeed is set.
+    bool hasSeed = false;
+    uint64_t seed = 0;
+    // Input log to write the game to, or to replay instead of taking live input.
+    std::string recordPath;
+    std::string replayPath;
+    // Per-phase timings, only available in builds with REALJUMP_PROFILE. Samples are exported to
+    // profilePath on exit, as a Chrome trace if it ends in .json and as CSV otherwise.
+    std::string profilePath;
+    bool profileOverlay = false;
+    // Generate the level on a worker thread of its own.
+    bool levelThread = true;
+    // Simulate and record each frame on a thread of its own while the main thread submits the
+    // previous one, see FramePipeline. Frames are shown a Tick later.
+    bool pipelined = false;
+    // Load the sprites in the background behind a loading screen, see AssetLoader. Otherwise Init
+    // loads all of them before it returns. Off by default on the headless backend: how many Ticks
+    // loading takes there depends on disk and thread timing, not on its virtual clock, so the same
+    // tick limit would run a different number of steps every time.
+#if defined(_WINDOWS)
+    bool streamAssets = true;
+#else
+    bool streamAssets = false;
+#endif
+};
+
+// The whole simulation state of a game as plain data of a fixed size, so it can be copied with
+// memcpy and kept in arrays, e.g. to roll back or to try several moves from the same state. Wall
+// clock timing, input logs and what was last drawn aren't part of it.
+struct GameSnapshot {
+    unsigned int stepCount;
+    uint64_t random;
+    LevelCursor level;
+    float levelX;
+    float levelTop;
+    float cameraTop;
+    float cameraPreviousTop;
+    Dimension mousePosition;
+    float backgroundOffset;
+    float backgroundPreviousOffset;
+    PlayerState player;
+    StoreSnapshot objects;
+    StoreSnapshot enemies;
+    StoreSnapshot projectiles;
+};
+
+static_assert(std::is_trivially_copyable_v<GameSnapshot>, "snapshots are copied as bytes");
+
+// Draws per frame since the game started, see DrawList.
+struct RenderStats {
+    uint64_t frames = 0;
+    uint64_t submitted = 0;
+    uint64_t culled = 0;
+    size_t maxSubmitted = 0;
+};
+
+// Projectiles travel this many pixels per millisecond towards the cursor position they were fired at.
+const float projectileSpeed = 3.f;
+
+class MyFramework : public Framework {
+    // Drive the simulation phases directly, see GameBatch.h and benchmarks/GameBenchmark.cpp.
+    friend class GameBatch;
+    friend class GameBenchmark;
+
+    Dimension windowSize;
+    AssetRegistry assets;
+    AssetLoader loader = AssetLoader(assets);
+    TextureAtlas atlas;
+    SpriteHandle loadingSprite;
+    SpriteHandle backgroundSprite;
+    SpriteHandle liveSprite;
+    SpriteHandle greenPlatformSprite;
+    SpriteHandle bluePlatformSprite;
+    SpriteHandle projectileSprite;
+    SpriteHandle jetpackSprite;
+    // In SpringSprite order.
+    SpriteHandle springSprites[SPRING_SPRITE_COUNT];
+    SpriteHandle enemySprites[12];
+    // In PlayerSprite order.
+    SpriteHandle playerSprites[PLAYER_SPRITE_COUNT];
+    // Created once the sprites gameplay needs are loaded.
+    Player* player = nullptr;
+    GlyphSet glyphs;
+    TextRun loadingText;
+    TextRun distanceText = TextRun(4, 4);
+    TextRun platformText = TextRun(4, 36);
+    EntityStore objects;
+    EntityStore enemies;
+    EntityStore projectiles;
+    // Collision results for UpdateProjectile, kept between steps so it doesn't allocate.
+    std::vector<unsigned int> enemyCandidates;
+    std::vector<unsigned int> enemyHits;
+    // Window position of the cursor.
+    Dimension mousePosition;
+    BackgroundLayer background;
+    Camera camera;
+    unsigned int lastTickCount = 0;
+    // Milliseconds of wall time not yet consumed by simulation steps.
+    unsigned int simulationLag = 0;
+    GameOptions options;
+    DrawList drawList;
+    FramePipeline pipeline;
+    RenderStats renderStats;
+    // Live input not applied yet, see InputQueue. A pipelined game collects it on the main thread
+    // and hands it to the simulation thread with the next frame.
+    InputQueue input;
+    std::vector<TimedInput> pendingInput;
+    std::vector<TimedInput> frameInput;
+    // Arrival times of the input applied since the last frame was recorded, and of the input the
+    // frame being submitted shows first. Only kept while rendering.
+    std::vector<unsigned int> appliedInput;
+    std::vector<unsigned int> shownInput;
+    // Milliseconds from the arrival of input to the submission of the first frame it affects.
+    DurationHistogram inputLatency;
+    // Clock reading the next pipelined frame catches up to.
+    unsigned int frameTickCount = 0;
+    Random random;
+    InputRecorder recorder;
+    InputReplay replay;
+    // Simulation steps run so far, input events are stamped with it.
+    unsigned int stepCount = 0;
+    FrameProfiler profiler;
+    LevelGenerator level;
+    LevelChunk chunk;
+    // Position of the last path platform placed, the next chunk is placed relative to it.
+    float levelX = 0;
+    float levelTop = 0;
+
+    void PreInit(int& width, int& height, bool& fullscreen) override
+    {
+        width = windowSize.x;
+        height = windowSize.y;
+        fullscreen = false;
+    }
+
+    // The player starts on this platform, the level is built up from it.
+    void InitPlatforms() {
+        Dimension start(player->position.x - player->sprites[0]->size.x / 4, player->position.y + player->sprites[0]->size.y);
+        objects.Add(greenPlatformSprite, start, ObjectType::JUMP);
+        levelX = start.x;
+        levelTop = start.y;
+        ExtendLevel();
+    }
+
+    void PlacePlatform(const LevelPlatform& platform) {
+        Dimension position(level.PlatformX(levelX, platform.dx), levelTop - platform.rise);
+        if (platform.path) {
+            levelX = position.x;
+            levelTop = position.y;
+        }
+
+        SpriteHandle sprite = platform.type == ObjectType::JUMP_BOOST ? bluePlatformSprite : greenPlatformSprite;
+        size_t index = objects.Add(sprite, position, platform.type);
+        if (index == EntityStore::none)
+            return;
+
+        float centerX = position.x + objects.width[index] / 2;
+        switch (platform.attachment) {
+        case ENEMY_ATTACHMENT: {
+            SpriteHandle enemySprite = enemySprites[platform.enemy];
+            Dimension size = assets[enemySprite]->size;
+            enemies.Add(enemySprite, Dimension(centerX - size.x / 2, position.y - size.y));
+            break;
+        }
+        case JETPACK_ATTACHMENT: {
+            Dimension size = assets[jetpackSprite]->size;
+            objects.Add(jetpackSprite, Dimension(centerX - size.x / 2, position.y - size.y), ObjectType::JETPACK);
+            break;
+        }
+        case NO_ATTACHMENT:
+            break;
+        }
+    }
+
+    // Places chunks from the generator until the level reaches a window height above the window.
+    void ExtendLevel() {
+        while (levelTop > camera.top - windowSize.y) {
+            level.Next(chunk);
+            for (size_t i = 0; i < chunk.count; i++)
+                PlacePlatform(chunk.platforms[i]);
+        }
+    }
+
+    // return : true - ok, false - failed, application will exit
+    bool Init() {
+        uint64_t seed = options.hasSeed ? options.seed : (uint64_t)time(0);
+        random.Seed(seed);
+
+        if (!options.replayPath.empty() && !replay.Load(options.replayPath)) {
+            std::cerr << "Can't read input log " << options.replayPath << std::endl;
+            return false;
+        }
+
+        if (!options.recordPath.empty() &&
+            !recorder.Open(options.recordPath, InputLogHeader{ seed, (int)windowSize.x, (int)windowSize.y })) {
+            std::cerr << "Can't write input log " << options.recordPath << std::endl;
+            return false;
+        }
+
+        if (!options.profilePath.empty())
+            profiler.StartTrace();
+
+        // The loading screen's own sprites, the glyphs double as the HUD font.
+        loadingSprite = assets.Load("data/loading.png");
+        glyphs.Load(assets, "data/char-set", "0123456789abceors");
+        RequestAssets();
+
+        if (options.streamAssets) {
+            loader.Start();
+        }
+        else {
+            loader.Finish();
+            StartGameplay();
+            FinishLoading();
+        }
+
+        return true;
+    }
+
+    // The rest of the sprites, in the order they are loaded.
+    void RequestAssets() {
+        loader.Request("data/bck@2x.png", ASSETS_GAMEPLAY, backgroundSprite);
+        const char* poses[] = { "data/lik-right-clipped@2x.png", "data/lik-left-clipped@2x.png",
+            "data/lik-right-odskok-clipped@2x.png", "data/lik-left-odskok-clipped@2x.png",
+            "data/lik-puca-clipped@2x.png", "data/lik-puca-odskok-clipped@2x.png" };
+        for (int i = 0; i < PLAYER_SPRITE_COUNT; i++)
+            loader.Request(poses[i], ASSETS_GAMEPLAY, playerSprites[i]);
+        loader.Request("data/game-tiles-green-platform-clipped@2x.png", ASSETS_GAMEPLAY, greenPlatformSprite);
+        loader.Request("data/game-tiles-blue-platform-clipped@2x.png", ASSETS_GAMEPLAY, bluePlatformSprite);
+        loader.Request("data/projectile-tiles0-clipped@2x.png", ASSETS_GAMEPLAY, projectileSprite);
+        loader.Request("data/game-tiles-jetpack-clipped@2x.png", ASSETS_GAMEPLAY, jetpackSprite);
+        loader.Request("data/game-tiles-tensioned-spring-clipped@2x.png", ASSETS_GAMEPLAY,
+            springSprites[SPRITE_SPRING_TENSIONED]);
+        loader.Request("data/game-tiles-untensioned-spring-clipped@2x.png", ASSETS_GAMEPLAY,
+            springSprites[SPRITE_SPRING_UNTENSIONED]);
+        for (size_t i = 0; i < sizeof(enemySprites) / sizeof(enemySprites[0]); i++) {
+            loader.Request("data/game-tiles-enemy" + std::to_string(i) + "-clipped@2x.png", ASSETS_GAMEPLAY,
+                enemySprites[i]);
+        }
+
+        loader.Request("data/lik-left.png", ASSETS_HUD, liveSprite);
+    }
+
+    // Sets the game up once the gameplay sprites are loaded.
+    void StartGameplay() {
+        MySprite** sprites = new MySprite * [PLAYER_SPRITE_COUNT];
+        for (int i = 0; i < PLAYER_SPRITE_COUNT; i++)
+            sprites[i] = assets[playerSprites[i]];
+        camera = Camera();
+        player = new Player(sprites, PLAYER_SPRITE_COUNT, Dimension(windowSize.x / 2, windowSize.y / 2));
+
+        background.Compose(assets[backgroundSprite], windowSize);
+
+        int enemyCount = sizeof(enemySprites) / sizeof(enemySprites[0]);
+        level.Start(random.Next(), LevelMetrics{ windowSize.x, assets[greenPlatformSprite]->size.x, enemyCount },
+            options.levelThread);
+
+        InitPlatforms();
+        lastTickCount = getTickCount();
+    }
+
+    // Called once every sprite is loaded.
+    void FinishLoading() {
+        // Everything the game draws is loaded by now, pack it so draws batch per atlas page.
+        atlas.Build(assets, assets.ResidentHandles());
+
+        if (options.pipelined) {
+            pendingInput.reserve(64);
+            frameInput.reserve(64);
+            pipeline.Start([this](DrawList& target) { return PipelinedFrame(target); });
+        }
+    }
+
+    // Creates the sprites read so far and starts the game once the ones it needs are there. A
+    // pipelined game waits for all of them, its simulation thread can't render while they load.
+    // return : true once the game is running.
+    bool StreamAssets() {
+        loader.Pump(loadingBudget);
+
+        if (!player && loader.Ready(ASSETS_GAMEPLAY) && (!options.pipelined || loader.Done()))
+            StartGameplay();
+        if (loader.Done())
+            FinishLoading();
+        if (player)
+            return true;
+
+        if (options.renderingEnabled)
+            RenderLoadingScreen();
+        return false;
+    }
+
+    // The loading sign in the middle of the window, with the percentage loaded under it.
+    void RenderLoadingScreen() {
+        MySprite* sign = assets[loadingSprite];
+        drawList.Add(sign, (int)(windowSize.x - sign->size.x) / 2, (int)(windowSize.y - sign->size.y) / 2, LAYER_HUD);
+        loadingText.SetNumber(loader.Progress(), glyphs, assets);
+        loadingText.Render(drawList);
+        drawList.Submit();
+    }
+
+    void CleanUp() {
+        objects.Clear();
+        enemies.Clear();
+        projectiles.Clear();
+    }
+
+    // Moves projectile i towards its target and knocks out any enemy it hits.
+    void UpdateProjectile(size_t i, float dt) {
+        projectiles.x[i] += projectiles.directionX[i] * projectileSpeed * dt;
+        projectiles.y[i] += projectiles.directionY[i] * projectileSpeed * dt;
+
+        // Check if projectile has gone off the screen.
+        if (projectiles.x[i] + projectiles.width[i] < 0) {
+            projectiles.Teleport(i, Dimension(windowSize.x, projectiles.y[i]));
+        }
+        else if (projectiles.x[i] > windowSize.x) {
+            projectiles.Teleport(i, Dimension(0, projectiles.y[i]));
+        }
+
+        enemyCandidates.clear();
+        enemies.Query(projectiles.y[i], projectiles.y[i] + projectiles.height[i], enemyCandidates);
+        // Lowest index first, so the enemy hit doesn't depend on the order within index buckets.
+        std::sort(enemyCandidates.begin(), enemyCandidates.end());
+
+        enemyHits.clear();
+        BatchCollision::FindOverlaps(Box{ projectiles.x[i], projectiles.y[i], projectiles.width[i], projectiles.height[i] },
+            enemies.Boxes(), enemyCandidates.data(), enemyCandidates.size(), enemyHits);
+
+        // The projectile is spent on the first enemy it hits.
+        if (!enemyHits.empty()) {
+            enemies.Destroy(enemyHits.front());
+            projectiles.Destroy(i);
+        }
+    }
+
+    void PrintStoreStats(const char* name, const EntityStore& store) {
+        std::cerr << name << ": high-water " << store.HighWaterMark() << " of " << store.Capacity()
+            << ", " << store.RejectedCount() << " rejected" << std::endl;
+    }
+
+    uint64_t ComputeStateHash() const {
+        StateHash hash;
+        hash.Add(player->position);
+        hash.Add(player->velocity);
+        hash.Add(player->lives);
+        hash.Add(player->distance);
+        hash.Add(player->platformCount);
+        hash.Add(player->moveDirection);
+
+        for (const EntityStore* store : { &objects, &enemies, &projectiles }) {
+            hash.Add(store->x);
+            hash.Add(store->y);
+            hash.Add(store->type);
+        }
+        return hash.Value();
+    }
+
+    // return : false if a store holds more entities than a snapshot does.
+    bool SaveSnapshot(GameSnapshot& snapshot) const {
+        snapshot.stepCount = stepCount;
+        snapshot.random = random.State();
+        snapshot.level = level.Cursor();
+        snapshot.levelX = levelX;
+        snapshot.levelTop = levelTop;
+        snapshot.cameraTop = camera.top;
+        snapshot.cameraPreviousTop = camera.previousTop;
+        snapshot.mousePosition = mousePosition;
+        snapshot.backgroundOffset = background.Offset();
+        snapshot.backgroundPreviousOffset = background.PreviousOffset();
+        player->Save(snapshot.player);
+        return objects.Save(snapshot.objects) && enemies.Save(snapshot.enemies) && projectiles.Save(snapshot.projectiles);
+    }
+
+    // Puts the game back in the state snapshot was saved in, by this game or another one of the same
+    // window size. The restore isn't recorded, so a game written to an input log only replays if it
+    // is never restored.
+    // return : false, leaving the game as it was, if the snapshot doesn't fit the stores.
+    bool RestoreSnapshot(const GameSnapshot& snapshot) {
+        if (snapshot.objects.count > objects.Capacity() || snapshot.enemies.count > enemies.Capacity() ||
+            snapshot.projectiles.count > projectiles.Capacity())
+            return false;
+
+        stepCount = snapshot.stepCount;
+        random.SetState(snapshot.random);
+        level.Seek(snapshot.level);
+        levelX = snapshot.levelX;
+        levelTop = snapshot.levelTop;
+        camera.top = snapshot.cameraTop;
+        camera.previousTop = snapshot.cameraPreviousTop;
+        mousePosition = snapshot.mousePosition;
+        background.Restore(snapshot.backgroundOffset, snapshot.backgroundPreviousOffset);
+        player->Restore(snapshot.player);
+        objects.Restore(snapshot.objects);
+        enemies.Restore(snapshot.enemies);
+        projectiles.Restore(snapshot.projectiles);
+        return true;
+    }
+
+    // Applies the logged records stamped with the current step and checks the logged state hashes.
+    // return : false once the log has ended or the game has diverged from it.
+    bool Replay() {
+        while (const InputEvent* event = replay.Next(stepCount)) {
+            if (event->type != STATE_HASH && event->type != END) {
+                Apply(*event);
+                continue;
+            }
+
+            if (ComputeStateHash() != event->hash) {
+                std::cerr << "replay: state diverged from the log at step " << stepCount << std::endl;
+                return false;
+            }
+
+            if (event->type == END) {
+                std::cerr << "replay: " << stepCount << " steps reproduced, final state hash " << std::hex
+                    << event->hash << std::dec << std::endl;
+                return false;
+            }
+        }
+        return true;
+    }
+
+    void Close() {
+        loader.Stop();
+        pipeline.Stop();
+        profiler.Drain();
+        if (!options.profilePath.empty() && !profiler.Export(options.profilePath))
+            std::cerr << "Can't write profile " << options.profilePath << std::endl;
+
+        // The game may be closed before it ever started.
+        uint64_t stateHash = player ? ComputeStateHash() : 0;
+        if (recorder.IsOpen())
+            recorder.Close(stepCount, stateHash);
+
+        if (options.printStats) {
+            std::cerr << "state: hash " << std::hex << stateHash << std::dec << " after " << stepCount
+                << " steps" << std::endl;
+            PrintStoreStats("objects", objects);
+            PrintStoreStats("enemies", enemies);
+            PrintStoreStats("projectiles", projectiles);
+
+            const AssetStats& assetStats = assets.Stats();
+            std::cerr << "assets: " << assetStats.residentCount << " resident (" << assetStats.bytesResident
+                << " bytes), " << assetStats.loadCount << " loads, " << assetStats.hitCount << " hits, "
+                << assetStats.missCount << " misses" << std::endl;
+            const DrawList& lastList = options.pipelined ? pipeline.Front() : drawList;
+            std::cerr << "atlas: " << atlas.PageCount() << " pages, " << (int)(atlas.FillRatio() * 100)
+                << "% filled, last frame drawn in " << lastList.LastBatchCount() << " batches" << std::endl;
+            if (renderStats.frames) {
+                std::cerr << "draws: " << renderStats.submitted / renderStats.frames << " submitted and "
+                    << renderStats.culled / renderStats.frames << " culled per frame, at most "
+                    << renderStats.maxSubmitted << " submitted" << std::endl;
+            }
+            if (inputLatency.Count()) {
+                std::cerr << "input: " << inputLatency.Count() << " events, shown after p50 "
+                    << inputLatency.Percentile(0.5) << " ms, p95 " << inputLatency.Percentile(0.95) << " ms, p99 "
+                    << inputLatency.Percentile(0.99) << " ms, max " << inputLatency.Max() << " ms" << std::endl;
+            }
+            std::cerr << "hud: distance laid out " << distanceText.RebuildCount() << " times, platforms "
+                << platformText.RebuildCount() << " times" << std::endl;
+            profiler.PrintSummary(std::cerr);
+        }
+
+        level.Stop();
+        CleanUp();
+
+        delete player;
+        player = nullptr;
+        input.Clear();
+        loadingText.Reset();
+        distanceText.Reset();
+        platformText.Reset();
+        profiler.ResetOverlay();
+        glyphs.Unload(assets);
+        assets.UnloadAll();
+    }
+
+    // Destroys the platforms and enemies that left through the bottom of the window.
+    void CullWorld() {
+        float bottom = camera.Bottom(windowSize.y);
+        // Platforms leave lowest first.
+        while (objects.Lowest() != EntityStore::none && objects.y[objects.Lowest()] > bottom)
+            objects.Destroy(objects.Lowest());
+
+        for (size_t i = 0; i < enemies.Size(); i++) {
+            if (enemies.y[i] > bottom)
+                enemies.Destroy(i);
+        }
+    }
+
+    // Removes everything destroyed during the step at once, before the next step or frame sees it.
+    void FlushDestroyed() {
+        objects.Flush();
+        enemies.Flush();
+        projectiles.Flush();
+    }
+
+    // Moves the whole world down by rebaseDistance once the camera has climbed that far, which
+    // only happens every few thousand steps of climbing.
+    void RebaseWorld() {
+        if (camera.top > -rebaseDistance)
+            return;
+
+        objects.Shift(rebaseDistance);
+        enemies.Shift(rebaseDistance);
+        projectiles.Shift(rebaseDistance);
+        player->position.y += rebaseDistance;
+        player->previousPosition.y += rebaseDistance;
+        camera.top += rebaseDistance;
+        camera.previousTop += rebaseDistance;
+        levelTop += rebaseDistance;
+    }
+
+    // Destroys projectiles that left the window and moves the rest.
+    void UpdateProjectiles(float dt) {
+        for (size_t i = 0; i < projectiles.Size(); i++) {
+            if (projectiles.IsDestroyed(i))
+                continue;
+
+            if (projectiles.y[i] > camera.Bottom(windowSize.y) || projectiles.y[i] + projectiles.height[i] < camera.top)
+                projectiles.Destroy(i);
+            else
+                UpdateProjectile(i, dt);
+        }
+    }
+
+    // Advances the game state by one fixed simulation step of dt milliseconds. Never draws.
+    void Simulate(float dt) {
+        // Platforms and enemies only move by Teleport, which leaves them nothing to interpolate.
+        projectiles.StorePreviousPositions();
+        player->previousPosition = player->position;
+        camera.previousTop = camera.top;
+        background.StorePreviousOffset();
+
+        {
+            PROFILE_SCOPE(profiler, PHASE_PROJECTILES);
+            UpdateProjectiles(dt);
+        }
+        {
+            PROFILE_SCOPE(profiler, PHASE_PLAYER);
+            player->Update(camera, windowSize, objects, enemies, dt);
+        }
+        {
+            // Following the player moves the camera alone; the world stays put apart from the culls.
+            PROFILE_SCOPE(profiler, PHASE_SCROLL);
+            background.Scroll(camera.previousTop - camera.top);
+            CullWorld();
+            FlushDestroyed();
+            RebaseWorld();
+        }
+        {
+            // The level is generated ahead on the worker thread, only placing it is left.
+            PROFILE_SCOPE(profiler, PHASE_SPAWN);
+            ExtendLevel();
+        }
+
+        if (player->gameOver) {
+            player->Reset();
+            CleanUp();
+            InitPlatforms();
+        }
+    }
+
+    // Draws the spring of every boost platform standing on its middle, in the pose springAnimation
+    // picks for the platform.
+    void RenderSprings(float alpha, float top, DrawList& target) const {
+        unsigned int time = stepCount * simulationStep;
+        for (size_t i = 0; i < objects.Size(); i++) {
+            if (objects.type[i] != ObjectType::JUMP_BOOST)
+                continue;
+
+            MySprite* spring = assets[springSprites[springAnimation.Sprite(objects.pose[i], time)]];
+            float x = objects.previousX[i] + (objects.x[i] - objects.previousX[i]) * alpha;
+            float y = objects.previousY[i] + (objects.y[i] - objects.previousY[i]) * alpha;
+            target.Add(spring, x + (objects.width[i] - spring->size.x) / 2, y - spring->size.y - top, LAYER_OBJECTS);
+        }
+    }
+
+    // Records the draw calls for the game state, interpolated alpha of the way from the previous
+    // simulation step to the current one. Only reads the state, never mutates it.
+    void Render(float alpha, DrawList& target) {
+        float top = camera.RenderTop(alpha);
+        {
+            PROFILE_SCOPE(profiler, PHASE_RENDER_BACKGROUND);
+            background.Render(alpha, target);
+        }
+        {
+            PROFILE_SCOPE(profiler, PHASE_RENDER_OBJECTS);
+            objects.Render(alpha, top, LAYER_OBJECTS, target);
+            RenderSprings(alpha, top, target);
+        }
+        {
+            PROFILE_SCOPE(profiler, PHASE_RENDER_ENEMIES);
+            enemies.Render(alpha, top, LAYER_ENEMIES, target);
+        }
+        {
+            PROFILE_SCOPE(profiler, PHASE_RENDER_PROJECTILES);
+            projectiles.Render(alpha, top, LAYER_PROJECTILES, target);
+        }
+        {
+            PROFILE_SCOPE(profiler, PHASE_RENDER_PLAYER);
+            player->Render(alpha, top, stepCount * simulationStep, target);
+        }
+
+        PROFILE_SCOPE(profiler, PHASE_RENDER_HUD);
+        if (loader.Ready(ASSETS_HUD)) {
+            for (int i = player->lives; i >= 0; i--) {
+                target.Add(assets[liveSprite], windowSize.x - 60 * i, 0, LAYER_HUD);
+            }
+        }
+
+        distanceText.SetNumber(player->distance, glyphs, assets);
+        distanceText.Render(target);
+        platformText.SetNumber(player->platformCount, glyphs, assets);
+        platformText.Render(target);
+
+        if (options.profileOverlay)
+            profiler.RenderOverlay(glyphs, assets, target);
+    }
+
+    // Simulates up to tickCount and records the frame into target.
+    // return : true if the game should exit.
+    bool Frame(unsigned int tickCount, DrawList& target) {
+        simulationLag = std::min(simulationLag + tickCount - lastTickCount, maxSimulationSteps * simulationStep);
+        lastTickCount = tickCount;
+
+        // Catch up with the wall clock in fixed steps, the remainder is interpolated when rendering.
+        while (simulationLag >= simulationStep) {
+            if (replay.IsLoaded() && !Replay())
+                return true;
+
+            // Input that arrived by the end of the time this step simulates.
+            TakeInput(tickCount - simulationLag + simulationStep);
+            Simulate(simulationStep);
+            simulationLag -= simulationStep;
+            stepCount++;
+
+            if (recorder.IsOpen() && stepCount % InputRecorder::hashInterval == 0) {
+                InputEvent checkpoint;
+                checkpoint.step = stepCount;
+                checkpoint.type = STATE_HASH;
+                checkpoint.hash = ComputeStateHash();
+                recorder.Write(checkpoint);
+            }
+        }
+
+        if (options.renderingEnabled)
+            Render((float)simulationLag / simulationStep, target);
+        return false;
+    }
+
+    // A frame on the simulation thread, queueing the input handed over with it first.
+    bool PipelinedFrame(DrawList& target) {
+        for (const TimedInput& timed : frameInput)
+            input.Push(timed.event, timed.time);
+        frameInput.clear();
+
+        return Frame(frameTickCount, target);
+    }
+
+    // return value: if true will exit the application
+    bool Tick() {
+        if (!loader.Done() && !StreamAssets())
+            return false;
+
+        if (options.pipelined)
+            return PipelinedTick();
+
+        // Last Tick's samples, folded in before this one adds more.
+        profiler.Drain();
+        PROFILE_SCOPE(profiler, PHASE_TICK);
+
+        if (Frame(getTickCount(), drawList))
+            return true;
+
+        if (options.renderingEnabled) {
+            PROFILE_SCOPE(profiler, PHASE_SUBMIT);
+            shownInput.swap(appliedInput);
+            SubmitFrame(drawList);
+        }
+        return false;
+    }
+
+    // Collects the frame simulated during the last Tick, starts the next one on the simulation
+    // thread and submits the collected one meanwhile.
+    bool PipelinedTick() {
+        PROFILE_SCOPE(profiler, PHASE_TICK);
+
+        if (pipeline.Wait())
+            return true;
+
+        // The simulation thread is idle until Next, so its profile samples and input are safe to touch.
+        profiler.Drain();
+        frameInput.swap(pendingInput);
+        shownInput.swap(appliedInput);
+        frameTickCount = getTickCount();
+        pipeline.Next();
+
+        if (options.renderingEnabled) {
+            PROFILE_SCOPE(profiler, PHASE_SUBMIT);
+            SubmitFrame(pipeline.Front());
+        }
+        return false;
+    }
+
+    // Submits list and counts its draws and the latency of the input it shows first.
+    void SubmitFrame(DrawList& list) {
+        list.Submit();
+        renderStats.frames++;
+        renderStats.submitted += list.LastSubmittedCount();
+        renderStats.culled += list.LastCulledCount();
+        renderStats.maxSubmitted = std::max(renderStats.maxSubmitted, list.LastSubmittedCount());
+
+        unsigned int now = getTickCount();
+        for (unsigned int arrival : shownInput)
+            inputLatency.Add(now - arrival);
+        shownInput.clear();
+    }
+
+    // Applies one input event, live or replayed, to the game.
+    void Apply(const InputEvent& event) {
+        switch (event.type) {
+        case InputType::MOUSE_MOVE:
+            mousePosition = Dimension(event.x, event.y);
+            break;
+        case InputType::MOUSE_BUTTON:
+            if (!event.released) {
+                Dimension position(player->position.x + player->sprites[0]->size.x / 4, player->position.y);
+
+                // Calculate direction towards cursor.
+                Dimension direction = Dimension(mousePosition.x, mousePosition.y + camera.top) - position;
+                float length = sqrt(direction.x * direction.x + direction.y * direction.y);
+                direction /= length; // Normalize direction vector.
+
+                projectiles.Add(projectileSprite, position, ObjectType::DEFAULT, direction);
+            }
+
+            player->shootingTicks = 150;
+            break;
+        case InputType::KEY_PRESSED:
+            switch ((FRKey)event.code) {
+            case FRKey::RIGHT:
+                player->moveDirection = Direction::RIGHT;
+                break;
+            case FRKey::LEFT:
+                player->moveDirection = Direction::LEFT;
+                break;
+            default:
+                break;
+            }
+            break;
+        case InputType::KEY_RELEASED:
+            if ((FRKey)event.code == FRKey::RIGHT || (FRKey)event.code == FRKey::LEFT)
+                player->moveDirection = Direction::NONE;
+            break;
+        case InputType::STATE_HASH:
+        case InputType::END:
+            // Checked by Replay, not input to the game.
+            break;
+        }
+    }
+
+    // Stamps live input with the current step and records it before applying it.
+    void Accept(InputEvent event) {
+        event.step = stepCount;
+        if (recorder.IsOpen())
+            recorder.Write(event);
+        Apply(event);
+    }
+
+    // Applies the queued input that arrived at or before time.
+    void TakeInput(unsigned int time) {
+        TimedInput timed;
+        while (input.Pop(time, timed)) {
+            Accept(timed.event);
+            if (options.renderingEnabled)
+                appliedInput.push_back(timed.time);
+        }
+    }
+
+    // Live input is ignored while replaying, the log is the only input then, and while loading. It
+    // is queued for the simulation, see InputQueue; a pipelined game hands it to the simulation
+    // thread with the next frame.
+    void Input(const InputEvent& event) {
+        if (replay.IsLoaded() || !player)
+            return;
+
+        if (options.pipelined)
+            pendingInput.push_back({ event, getTickCount() });
+        else
+            input.Push(event, getTickCount());
+    }
+
+    // param: xrel, yrel: The relative motion in the X/Y direction 
+    // param: x, y : coordinate, relative to window
+    void onMouseMove(int x, int y, int /*xrelative*/, int /*yrelative*/) {
+        InputEvent event;
+        event.type = InputType::MOUSE_MOVE;
+        event.x = x;
+        event.y = y;
+        Input(event);
+    }
+
+    void onMouseButtonClick(FRMouseButton button, bool isReleased) {
+        InputEvent event;
+        event.type = InputType::MOUSE_BUTTON;
+        event.code = (int)button;
+        event.released = isReleased;
+        Input(event);
+    }
+
+    void onKeyPressed(FRKey k) {
+        InputEvent event;
+        event.type = InputType::KEY_PRESSED;
+        event.code = (int)k;
+        Input(event);
+    }
+
+    void onKeyReleased(FRKey k) {
+        InputEvent event;
+        event.type = InputType::KEY_RELEASED;
+        event.code = (int)k;
+        Input(event);
+    }
+
+    const char* GetTitle() {
+        return "RealJump";
+    }
+
+public:
+    MyFramework(int width, int height, const GameOptions& options = GameOptions())
+        : windowSize(width, height), loadingText(width / 2 - 24, height / 2 + 24),
+        objects(assets, options.entityCapacity, SPATIAL_INDEX | HEIGHT_ORDER),
+        enemies(assets, options.entityCapacity, SPATIAL_INDEX),
+        projectiles(assets, options.entityCapacity), options(options) {
+        drawList.SetViewport(width, height);
+        pipeline.SetViewport(width, height);
+    }
+};
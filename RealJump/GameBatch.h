@@ -0,0 +1,254 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include "Game.h"
+#include "ThreadPool.h"
+
+// What a controller does in one simulation step.
+struct BatchAction {
+    Direction move = Direction::NONE;
+    bool shoot = false;
+    // Window position the projectile is fired towards.
+    float aimX = 0;
+    float aimY = 0;
+};
+
+enum ObservedKind {
+    OBSERVED_PLATFORM,
+    OBSERVED_BOOST_PLATFORM,
+    OBSERVED_JETPACK,
+    OBSERVED_ENEMY
+};
+
+struct ObservedEntity {
+    ObservedKind kind;
+    // Window position of the top left corner.
+    float x;
+    float y;
+    float width;
+    float height;
+};
+
+// State of one game after a step. Plain data of a fixed size, so a whole batch is one contiguous
+// array that can be handed to a learner as is.
+struct Observation {
+    static constexpr size_t nearbyCapacity = 16;
+
+    uint64_t step;
+    float x;
+    float y;
+    float velocity;
+    int lives;
+    int distance;
+    int platformCount;
+    // Games lost so far; a lost game restarts by itself.
+    int gameOvers;
+    // Entities closest to the player, nearest first.
+    unsigned int nearbyCount;
+    ObservedEntity nearby[nearbyCapacity];
+};
+
+// Many independent headless games stepped together on a work-stealing pool, for automated play
+// testing. The games don't use the framework's run loop or clock: each Step is exactly one
+// simulation step, so a batch runs as fast as the cores allow and every game is reproducible from
+// its seed and actions alone.
+//
+// The games are created and destroyed on the calling thread, since loading sprites goes through
+// the framework.
+class GameBatch {
+    // Games a thread takes at a time; small enough for stealing to balance uneven games.
+    static constexpr size_t grain = 4;
+    // Entities this far above or below the player are never observed.
+    static constexpr float observedRange = 600;
+
+    std::vector<std::unique_ptr<MyFramework>> games;
+    std::vector<Observation> observations;
+    std::vector<int> gameOvers;
+    ThreadPool pool;
+
+    struct Candidate {
+        float distance;
+        ObservedEntity entity;
+    };
+
+    // Candidates of one Observe, per game so threads don't share them.
+    std::vector<std::vector<unsigned int>> indices;
+    std::vector<std::vector<Candidate>> candidates;
+
+    static void Apply(MyFramework& game, const BatchAction& action, bool shoot) {
+        game.player->moveDirection = action.move;
+
+        if (shoot && action.shoot) {
+            InputEvent aim;
+            aim.type = InputType::MOUSE_MOVE;
+            aim.x = (int)action.aimX;
+            aim.y = (int)action.aimY;
+            game.Apply(aim);
+
+            InputEvent click;
+            click.type = InputType::MOUSE_BUTTON;
+            click.code = (int)FRMouseButton::LEFT;
+            game.Apply(click);
+        }
+    }
+
+    void Advance(size_t i) {
+        MyFramework& game = *games[i];
+        int lives = game.player->lives;
+        game.Simulate(simulationStep);
+        game.stepCount++;
+        // A lost game restarts with full lives within the same step.
+        gameOvers[i] += game.player->lives > lives;
+    }
+
+    void Observe(size_t i) {
+        MyFramework& game = *games[i];
+        const Player& player = *game.player;
+        Observation& observation = observations[i];
+
+        // The game keeps world coordinates, observations are relative to the window.
+        float top = game.camera.top;
+        observation.step = game.stepCount;
+        observation.x = player.position.x;
+        observation.y = player.position.y - top;
+        observation.velocity = player.velocity;
+        observation.lives = player.lives;
+        observation.distance = player.distance;
+        observation.platformCount = player.platformCount;
+        observation.gameOvers = gameOvers[i];
+
+        Dimension center = player.position + player.sprites[0]->size * 0.5f;
+        std::vector<Candidate>& nearest = candidates[i];
+        nearest.clear();
+
+        for (const EntityStore* store : { &game.objects, &game.enemies }) {
+            indices[i].clear();
+            store->Query(center.y - observedRange, center.y + observedRange, indices[i]);
+
+            for (unsigned int entity : indices[i]) {
+                ObservedKind kind = OBSERVED_ENEMY;
+                if (store == &game.objects) {
+                    kind = store->type[entity] == ObjectType::JETPACK ? OBSERVED_JETPACK :
+                        store->type[entity] == ObjectType::JUMP_BOOST ? OBSERVED_BOOST_PLATFORM : OBSERVED_PLATFORM;
+                }
+
+                ObservedEntity observed{ kind, store->x[entity], store->y[entity] - top, store->width[entity],
+                    store->height[entity] };
+                float dx = observed.x + observed.width / 2 - center.x;
+                float dy = store->y[entity] + observed.height / 2 - center.y;
+                nearest.push_back(Candidate{ dx * dx + dy * dy, observed });
+            }
+        }
+
+        size_t count = std::min(nearest.size(), Observation::nearbyCapacity);
+        std::partial_sort(nearest.begin(), nearest.begin() + count, nearest.end(),
+            [](const Candidate& a, const Candidate& b) { return a.distance < b.distance; });
+
+        observation.nearbyCount = (unsigned int)count;
+        for (size_t j = 0; j < count; j++)
+            observation.nearby[j] = nearest[j].entity;
+    }
+
+public:
+    // param: seed : game i is seeded with seed + i.
+    // param: threadCount : threads stepping the games including the calling one, 0 for one per
+    // hardware thread.
+    GameBatch(size_t count, uint64_t seed, unsigned int threadCount = 0, int width = 800, int height = 1000,
+        const GameOptions& baseOptions = GameOptions())
+        : observations(count), gameOvers(count), pool(threadCount), indices(count), candidates(count) {
+        for (size_t i = 0; i < count; i++) {
+            GameOptions options = baseOptions;
+            options.renderingEnabled = false;
+            options.levelThread = false;
+            options.streamAssets = false;
+            options.hasSeed = true;
+            options.seed = seed + i;
+
+            games.push_back(std::make_unique<MyFramework>(width, height, options));
+            MyFramework& game = *games.back();
+
+            int windowWidth, windowHeight;
+            bool fullscreen;
+            game.PreInit(windowWidth, windowHeight, fullscreen);
+            if (!game.Init()) {
+                games.pop_back();
+                break;
+            }
+            Observe(i);
+        }
+        observations.resize(games.size());
+    }
+
+    ~GameBatch() {
+        for (std::unique_ptr<MyFramework>& game : games)
+            game->Close();
+    }
+
+    GameBatch(const GameBatch&) = delete;
+    GameBatch& operator=(const GameBatch&) = delete;
+
+    // Fewer than asked for if a game failed to start.
+    size_t Size() const {
+        return games.size();
+    }
+
+    size_t ThreadCount() const {
+        return pool.ThreadCount();
+    }
+
+    // Observation of game i is at index i.
+    const Observation* Observations() const {
+        return observations.data();
+    }
+
+    // Saves the state of game, e.g. to try several actions from it in turn.
+    // return : false if the game has more entities than a snapshot holds.
+    bool Save(size_t game, GameSnapshot& snapshot) const {
+        return games[game]->SaveSnapshot(snapshot);
+    }
+
+    // Puts game back in a saved state and observes it again. Its gameOvers count keeps counting the
+    // games lost before the restore.
+    bool Restore(size_t game, const GameSnapshot& snapshot) {
+        if (!games[game]->RestoreSnapshot(snapshot))
+            return false;
+
+        Observe(game);
+        return true;
+    }
+
+    // Lockstep: applies actions[i] to game i, then advances every game by steps simulation steps and
+    // observes the result. The player keeps moving for all the steps but shoots only on the first.
+    void Step(const BatchAction* actions, unsigned int steps = 1) {
+        pool.ParallelFor(games.size(), grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                for (unsigned int step = 0; step < steps; step++) {
+                    Apply(*games[i], actions[i], step == 0);
+                    Advance(i);
+                }
+                Observe(i);
+            }
+        });
+    }
+
+    // Independent: runs every game for steps simulation steps, asking controller for the action of
+    // each step given the game's last observation. Games don't wait for each other, so controller
+    // is called concurrently for different games and must be safe to.
+    void Run(unsigned int steps, const std::function<BatchAction(size_t game, const Observation&)>& controller) {
+        pool.ParallelFor(games.size(), grain, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) {
+                for (unsigned int step = 0; step < steps; step++) {
+                    Apply(*games[i], controller(i, observations[i]), true);
+                    Advance(i);
+                    Observe(i);
+                }
+            }
+        });
+    }
+};
@@ -0,0 +1,70 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Entity indices kept sorted by y, top of the screen first, so the highest and lowest entities are
+// found in O(1). Shifting moves every entity by the same amount and float rounding is monotonic, so
+// it never reorders them and needs no update; only entities that move on their own must be erased
+// and reinserted. Lookups are binary searches over a vector reserved up front, so updates don't
+// touch the heap either.
+class HeightOrder {
+    std::vector<unsigned int> order;
+
+    // return : position of index in order, found among the entries at its height.
+    std::vector<unsigned int>::iterator Find(unsigned int index, const std::vector<float>& y) {
+        auto first = std::lower_bound(order.begin(), order.end(), y[index],
+            [&y](unsigned int entity, float height) { return y[entity] < height; });
+        return std::find(first, order.end(), index);
+    }
+
+public:
+    void Reserve(size_t capacity) {
+        order.reserve(capacity);
+    }
+
+    // param: y : heights of all entities, including the inserted one.
+    void Insert(unsigned int index, const std::vector<float>& y) {
+        auto position = std::upper_bound(order.begin(), order.end(), y[index],
+            [&y](float height, unsigned int entity) { return height < y[entity]; });
+        order.insert(position, index);
+    }
+
+    // param: y : heights of all entities, as they were when index was inserted or last shifted.
+    void Erase(unsigned int index, const std::vector<float>& y) {
+        order.erase(Find(index, y));
+    }
+
+    // The entity stored under oldIndex is now known as newIndex. Call before its height moves to newIndex.
+    void Rename(unsigned int oldIndex, unsigned int newIndex, const std::vector<float>& y) {
+        *Find(oldIndex, y) = newIndex;
+    }
+
+    void Clear() {
+        order.clear();
+    }
+
+    // Entity indices, top of the screen first.
+    const std::vector<unsigned int>& Entries() const {
+        return order;
+    }
+
+    // Replaces the order with count entries read from Entries, ties between equal heights included.
+    void Assign(const unsigned int* entries, size_t count) {
+        order.assign(entries, entries + count);
+    }
+
+    bool Empty() const {
+        return order.empty();
+    }
+
+    // return : index of the entity with the smallest y.
+    unsigned int Highest() const {
+        return order.front();
+    }
+
+    // return : index of the entity with the largest y.
+    unsigned int Lowest() const {
+        return order.back();
+    }
+};
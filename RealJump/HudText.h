@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <charconv>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "AssetRegistry.h"
+#include "DrawList.h"
+
+// Sprites of a bitmap font, one file per character, in a flat table indexed by the character.
+class GlyphSet {
+    std::array<SpriteHandle, 128> glyphs;
+    int advance = 0;
+
+public:
+    // Loads directory/<c>.png for every character c in characters.
+    void Load(AssetRegistry& assets, const std::string& directory, std::string_view characters) {
+        for (char c : characters) {
+            if ((unsigned char)c >= glyphs.size())
+                continue;
+
+            SpriteHandle glyph = assets.Load(directory + "/" + c + ".png");
+            glyphs[(unsigned char)c] = glyph;
+            advance = std::max(advance, (int)assets[glyph]->size.x);
+        }
+    }
+
+    void Unload(AssetRegistry& assets) {
+        for (SpriteHandle& glyph : glyphs) {
+            assets.Unload(glyph);
+            glyph = SpriteHandle();
+        }
+        advance = 0;
+    }
+
+    // return : glyph of c, an invalid handle if the font doesn't have it.
+    SpriteHandle operator[](char c) const {
+        return (unsigned char)c < glyphs.size() ? glyphs[(unsigned char)c] : SpriteHandle();
+    }
+
+    // Horizontal distance between consecutive characters.
+    int Advance() const {
+        return advance;
+    }
+};
+
+// A line of HUD text whose layout is cached as ready-made draw commands and only rebuilt when the
+// text changes, so a stable value costs one copy of its glyph run per frame. The glyphs share an
+// atlas page, so DrawList submits the whole run as one batch.
+class TextRun {
+    int x;
+    int y;
+    std::string text;
+    bool hasNumber = false;
+    int number = 0;
+    std::vector<DrawCommand> layout;
+    size_t rebuildCount = 0;
+
+public:
+    TextRun(int x, int y) : x(x), y(y) {}
+
+    // Characters the font doesn't have are left blank.
+    void SetText(std::string_view newText, const GlyphSet& glyphs, const AssetRegistry& assets) {
+        if (newText == text && !layout.empty())
+            return;
+
+        text = newText;
+        hasNumber = false;
+        layout.clear();
+        rebuildCount++;
+
+        for (size_t i = 0; i < text.size(); i++) {
+            SpriteHandle glyph = glyphs[text[i]];
+            if (glyph.IsValid())
+                layout.push_back({ assets[glyph], x + (int)i * glyphs.Advance(), y, 0, 0, LAYER_HUD });
+        }
+    }
+
+    // Compares the number before formatting it, so an unchanged value costs nothing.
+    void SetNumber(int value, const GlyphSet& glyphs, const AssetRegistry& assets) {
+        if (hasNumber && value == number)
+            return;
+
+        char digits[16];
+        char* end = std::to_chars(digits, digits + sizeof(digits), value).ptr;
+        SetText(std::string_view(digits, end - digits), glyphs, assets);
+        hasNumber = true;
+        number = value;
+    }
+
+    // Forgets the layout, e.g. when the glyphs it points to are unloaded.
+    void Reset() {
+        text.clear();
+        hasNumber = false;
+        layout.clear();
+    }
+
+    void Render(DrawList& drawList) const {
+        drawList.AddRun(layout);
+    }
+
+    // Number of times the layout has been rebuilt.
+    size_t RebuildCount() const {
+        return rebuildCount;
+    }
+};
@@ -0,0 +1,283 @@
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Input recording and replay. A log starts with the seed and window size of the game, followed by
+// one record per input event, stamped with the number of simulation steps run before it arrived.
+// Replaying the records at the same steps reproduces the game exactly, whatever the frame rate.
+// The recorder also writes the state hash every hashInterval steps and at the end of the game, so
+// a replay can tell where it diverged.
+//
+// Format, little-endian: "RJIN", version byte, seed (8 bytes), width and height (4 bytes each),
+// then records of: step delta (varint), InputType byte, payload. Keys and mouse buttons are one
+// byte (buttons carry the release flag in the top bit), mouse positions two zigzag varints and
+// state hashes 8 bytes.
+
+enum InputType {
+    KEY_PRESSED,
+    KEY_RELEASED,
+    MOUSE_MOVE,
+    MOUSE_BUTTON,
+    STATE_HASH,
+    // Last record, carries the final state hash.
+    END,
+};
+
+struct InputEvent {
+    unsigned int step = 0;
+    InputType type = END;
+    // Key or mouse button.
+    int code = 0;
+    bool released = false;
+    int x = 0;
+    int y = 0;
+    uint64_t hash = 0;
+};
+
+struct InputLogHeader {
+    uint64_t seed = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// FNV-1a over the raw bytes of the game state.
+class StateHash {
+    uint64_t value = 0xCBF29CE484222325ull;
+
+public:
+    void Add(const void* data, size_t size) {
+        const unsigned char* bytes = (const unsigned char*)data;
+        for (size_t i = 0; i < size; i++)
+            value = (value ^ bytes[i]) * 0x100000001B3ull;
+    }
+
+    template <typename T>
+    void Add(const T& value) {
+        Add(&value, sizeof(value));
+    }
+
+    template <typename T>
+    void Add(const std::vector<T>& values) {
+        Add(values.data(), values.size() * sizeof(T));
+    }
+
+    uint64_t Value() const {
+        return value;
+    }
+};
+
+class InputRecorder {
+    static constexpr unsigned char version = 1;
+
+    std::ofstream file;
+    unsigned int lastStep = 0;
+
+    void WriteByte(unsigned char byte) {
+        file.put((char)byte);
+    }
+
+    void WriteFixed(uint64_t value, int bytes) {
+        for (int i = 0; i < bytes; i++)
+            WriteByte((unsigned char)(value >> (8 * i)));
+    }
+
+    void WriteVarint(uint64_t value) {
+        while (value >= 0x80) {
+            WriteByte((unsigned char)(value | 0x80));
+            value >>= 7;
+        }
+        WriteByte((unsigned char)value);
+    }
+
+    void WriteSigned(int value) {
+        WriteVarint(((uint64_t)(int64_t)value << 1) ^ (uint64_t)(int64_t)(value >> 31));
+    }
+
+public:
+    // Steps between two state hashes.
+    static constexpr unsigned int hashInterval = 250;
+
+    bool Open(const std::string& path, const InputLogHeader& header) {
+        file.open(path, std::ios::binary | std::ios::trunc);
+        if (!file)
+            return false;
+
+        file.write("RJIN", 4);
+        WriteByte(version);
+        WriteFixed(header.seed, 8);
+        WriteFixed((uint32_t)header.width, 4);
+        WriteFixed((uint32_t)header.height, 4);
+        lastStep = 0;
+        return true;
+    }
+
+    bool IsOpen() const {
+        return file.is_open();
+    }
+
+    void Write(const InputEvent& event) {
+        WriteVarint(event.step - lastStep);
+        lastStep = event.step;
+        WriteByte((unsigned char)event.type);
+
+        switch (event.type) {
+        case KEY_PRESSED:
+        case KEY_RELEASED:
+            WriteByte((unsigned char)event.code);
+            break;
+        case MOUSE_BUTTON:
+            WriteByte((unsigned char)(event.code | (event.released ? 0x80 : 0)));
+            break;
+        case MOUSE_MOVE:
+            WriteSigned(event.x);
+            WriteSigned(event.y);
+            break;
+        case STATE_HASH:
+        case END:
+            WriteFixed(event.hash, 8);
+            break;
+        }
+    }
+
+    // Writes the END record and closes the log.
+    void Close(unsigned int step, uint64_t hash) {
+        InputEvent end;
+        end.step = step;
+        end.type = END;
+        end.hash = hash;
+        Write(end);
+        file.close();
+    }
+};
+
+class InputReplay {
+    std::vector<InputEvent> events;
+    size_t next = 0;
+
+    class Reader {
+        std::ifstream& file;
+
+    public:
+        bool failed = false;
+
+        explicit Reader(std::ifstream& file) : file(file) {}
+
+        unsigned char Byte() {
+            int c = file.get();
+            if (c == EOF)
+                failed = true;
+            return (unsigned char)c;
+        }
+
+        uint64_t Fixed(int bytes) {
+            uint64_t value = 0;
+            for (int i = 0; i < bytes; i++)
+                value |= (uint64_t)Byte() << (8 * i);
+            return value;
+        }
+
+        uint64_t Varint() {
+            uint64_t value = 0;
+            for (int shift = 0; shift < 64 && !failed; shift += 7) {
+                unsigned char byte = Byte();
+                value |= (uint64_t)(byte & 0x7F) << shift;
+                if (!(byte & 0x80))
+                    break;
+            }
+            return value;
+        }
+
+        int Signed() {
+            uint64_t value = Varint();
+            return (int)(int64_t)((value >> 1) ^ (~(value & 1) + 1));
+        }
+    };
+
+    static bool ReadHeader(std::ifstream& file, Reader& reader, InputLogHeader& header) {
+        char magic[4] = {};
+        file.read(magic, 4);
+        if (!file || std::memcmp(magic, "RJIN", 4) != 0 || reader.Byte() != 1)
+            return false;
+
+        header.seed = reader.Fixed(8);
+        header.width = (int)reader.Fixed(4);
+        header.height = (int)reader.Fixed(4);
+        return !reader.failed;
+    }
+
+public:
+    InputLogHeader header;
+
+    // Reads only the header, to set the game up before it starts.
+    static bool ReadHeader(const std::string& path, InputLogHeader& header) {
+        std::ifstream file(path, std::ios::binary);
+        Reader reader(file);
+        return file && ReadHeader(file, reader, header);
+    }
+
+    // return : false if the file is missing, malformed or has no END record.
+    bool Load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        Reader reader(file);
+        if (!file || !ReadHeader(file, reader, header))
+            return false;
+
+        events.clear();
+        next = 0;
+        unsigned int step = 0;
+
+        while (true) {
+            InputEvent event;
+            step += (unsigned int)reader.Varint();
+            event.step = step;
+            event.type = (InputType)reader.Byte();
+            if (reader.failed)
+                return false;
+
+            switch (event.type) {
+            case KEY_PRESSED:
+            case KEY_RELEASED:
+                event.code = reader.Byte();
+                break;
+            case MOUSE_BUTTON: {
+                unsigned char byte = reader.Byte();
+                event.code = byte & 0x7F;
+                event.released = byte & 0x80;
+                break;
+            }
+            case MOUSE_MOVE:
+                event.x = reader.Signed();
+                event.y = reader.Signed();
+                break;
+            case STATE_HASH:
+            case END:
+                event.hash = reader.Fixed(8);
+                break;
+            default:
+                return false;
+            }
+
+            if (reader.failed)
+                return false;
+
+            events.push_back(event);
+            if (event.type == END)
+                return true;
+        }
+    }
+
+    bool IsLoaded() const {
+        return !events.empty();
+    }
+
+    // return : next record if it is stamped with step, nullptr otherwise.
+    const InputEvent* Next(unsigned int step) {
+        if (next < events.size() && events[next].step == step)
+            return &events[next++];
+        return nullptr;
+    }
+};
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <vector>
+
+#include "InputLog.h"
+
+// A live input event and the tick count it arrived at.
+struct TimedInput {
+    InputEvent event;
+    unsigned int time;
+};
+
+// Live input waiting for the simulation. The framework callbacks only push events, stamped with
+// getTickCount, and each simulation step takes the ones that arrived by the end of the stretch of
+// time it simulates before it runs. Input so lands on the step matching when it arrived, however
+// the callbacks fall between Ticks. Events arrive in time order, so the queue is a vector read from
+// the front and emptied once it is drained.
+class InputQueue {
+    std::vector<TimedInput> events;
+    size_t next = 0;
+
+public:
+    InputQueue() {
+        events.reserve(64);
+    }
+
+    void Push(const InputEvent& event, unsigned int time) {
+        events.push_back({ event, time });
+    }
+
+    // Takes the next event if it arrived at or before time.
+    // return : false if there is no such event.
+    bool Pop(unsigned int time, TimedInput& event) {
+        if (next == events.size() || events[next].time > time)
+            return false;
+
+        event = events[next++];
+        if (next == events.size())
+            Clear();
+        return true;
+    }
+
+    void Clear() {
+        events.clear();
+        next = 0;
+    }
+
+    bool Empty() const {
+        return next == events.size();
+    }
+};
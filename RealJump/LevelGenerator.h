@@ -0,0 +1,240 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cmath>
+#include <cstdint>
+#include <thread>
+
+#include "EntityStore.h"
+#include "Player.h"
+#include "Random.h"
+#include "SpscQueue.h"
+
+enum LevelAttachment {
+    NO_ATTACHMENT,
+    ENEMY_ATTACHMENT,
+    JETPACK_ATTACHMENT
+};
+
+// A platform of a level chunk, positioned relative to the last path platform placed before it.
+struct LevelPlatform {
+    // Path platforms form a chain the player can always climb, the others are extras.
+    bool path;
+    float dx;
+    // Height above the last path platform.
+    float rise;
+    ObjectType type;
+    LevelAttachment attachment;
+    // Sprite of the enemy attachment.
+    int enemy;
+};
+
+// Where the generator is in the level, enough to generate the rest of it from there.
+struct LevelCursor {
+    uint64_t random;
+    float pathX;
+};
+
+// A vertical section of the level, about LevelGenerator::chunkHeight high.
+struct LevelChunk {
+    static constexpr size_t capacity = 64;
+
+    std::array<LevelPlatform, capacity> platforms;
+    size_t count = 0;
+    // Generator state right after this chunk, the next one is generated from it.
+    LevelCursor end = {};
+};
+
+struct LevelMetrics {
+    float windowWidth;
+    float platformWidth;
+    int enemyCount;
+};
+
+// Generates the level a chunk at a time on a worker thread, ahead of the game, and hands finished
+// chunks over through a lock-free queue. The chunk sequence only depends on the seed, so a game
+// that takes the same chunks at the same steps plays out the same whatever the thread timing, or
+// whether the chunks are generated in the background at all.
+//
+// Every path platform is within a normal jump of the one before it, given the player's jump
+// physics. Positions are relative, so the chain stays climbable from wherever the game anchors it.
+class LevelGenerator {
+    // Rise of the path in one chunk.
+    static constexpr float chunkHeight = 1024;
+    static constexpr int minGap = 60;
+    // Path gaps stay this far below the apex of a normal jump.
+    static constexpr float gapMargin = 60;
+    // Fraction of the horizontal reach of a jump a path platform may be off to the side.
+    static constexpr float reachMargin = 0.75f;
+    // Extra platforms keep their centers this far from the path platform level with them, so
+    // enemies standing on them don't block the path.
+    static constexpr float sideClearance = 300;
+    static constexpr int boostChance = 15;
+    static constexpr int jetpackChance = 1;
+    static constexpr int sideChance = 30;
+    static constexpr int enemyChance = 50;
+
+    LevelMetrics metrics = {};
+    Random random;
+    // Where the last path platform ends up if the game anchors the level where the worker assumes.
+    float pathX = 0;
+    SpscQueue<LevelChunk, 4> queue;
+    std::atomic<unsigned int> produced = 0;
+    std::atomic<unsigned int> consumed = 0;
+    std::atomic<bool> stopping = false;
+    std::thread worker;
+    bool background = true;
+    // End of the last chunk the game took. The worker may be chunks further ahead.
+    LevelCursor taken = {};
+
+    // return : distance the player moves sideways from jumping off a platform until falling back past
+    // rise above it.
+    static float Reach(float rise) {
+        float speed = Player::jumpSpeed;
+        float time = (speed + std::sqrt(speed * speed - 2 * Player::gravity * rise)) / Player::gravity;
+        return Player::moveSpeed * time;
+    }
+
+    static int MaxGap() {
+        return (int)(Player::jumpSpeed * Player::jumpSpeed / (2 * Player::gravity) - gapMargin);
+    }
+
+    float MaxX() const {
+        return metrics.windowWidth - metrics.platformWidth;
+    }
+
+    void Generate(LevelChunk& chunk) {
+        chunk.count = 0;
+
+        for (float height = 0; height < chunkHeight && chunk.count + 2 <= LevelChunk::capacity; ) {
+            LevelPlatform step = {};
+            step.path = true;
+            step.rise = (float)random.Range(minGap, MaxGap());
+            // Drawn from the part of the reach inside the window, clamping would pile platforms up at the edges.
+            int reach = (int)(Reach(step.rise) * reachMargin);
+            step.dx = (float)random.Range(std::max(-reach, -(int)pathX), std::min(reach, (int)(MaxX() - pathX)));
+            step.type = random.Range(0, 99) < boostChance ? ObjectType::JUMP_BOOST : ObjectType::JUMP;
+            step.attachment = random.Range(0, 99) < jetpackChance ? JETPACK_ATTACHMENT : NO_ATTACHMENT;
+            chunk.platforms[chunk.count++] = step;
+
+            pathX = PlatformX(pathX, step.dx);
+            height += step.rise;
+
+            if (random.Range(0, 99) < sideChance) {
+                // Centers left of the path platform first, then right of it.
+                float halfWidth = metrics.platformWidth / 2;
+                float pathCenter = pathX + halfWidth;
+                int left = std::max(0, (int)(pathCenter - sideClearance - halfWidth));
+                int right = std::max(0, (int)(metrics.windowWidth - halfWidth - (pathCenter + sideClearance)));
+                if (left + right == 0)
+                    continue;
+
+                int pick = random.Range(0, left + right - 1);
+                float center = pick < left ? halfWidth + pick : pathCenter + sideClearance + (pick - left);
+
+                LevelPlatform side = {};
+                side.dx = center - halfWidth - pathX;
+                side.rise = (float)random.Range(-30, 30);
+                side.type = random.Range(0, 99) < boostChance ? ObjectType::JUMP_BOOST : ObjectType::JUMP;
+                if (random.Range(0, 99) < enemyChance) {
+                    side.attachment = ENEMY_ATTACHMENT;
+                    side.enemy = random.Range(0, metrics.enemyCount - 1);
+                }
+                chunk.platforms[chunk.count++] = side;
+            }
+        }
+        chunk.end = LevelCursor{ random.State(), pathX };
+    }
+
+    void Run() {
+        LevelChunk chunk;
+        while (true) {
+            Generate(chunk);
+
+            while (true) {
+                unsigned int seen = consumed.load(std::memory_order_acquire);
+                if (stopping.load(std::memory_order_acquire))
+                    return;
+                if (queue.TryPush(chunk))
+                    break;
+                // Far enough ahead, sleep until the game takes a chunk.
+                consumed.wait(seen, std::memory_order_acquire);
+            }
+
+            produced.fetch_add(1, std::memory_order_release);
+            produced.notify_one();
+        }
+    }
+
+public:
+    ~LevelGenerator() {
+        Stop();
+    }
+
+    // Starts generating a new level, dropping any chunks left from the last one.
+    // param: background : false to generate each chunk when it is taken instead, e.g. when many
+    // games already share the cores.
+    void Start(uint64_t seed, const LevelMetrics& levelMetrics, bool inBackground = true) {
+        metrics = levelMetrics;
+        background = inBackground;
+        Random start(seed);
+        Seek(LevelCursor{ start.State(), MaxX() / 2 });
+    }
+
+    LevelCursor Cursor() const {
+        return taken;
+    }
+
+    // Continues the level from cursor, as if the chunks up to it had just been taken. Restarts the
+    // worker, so it is cheaper when generating inline.
+    void Seek(const LevelCursor& cursor) {
+        Stop();
+
+        random.SetState(cursor.random);
+        pathX = cursor.pathX;
+        taken = cursor;
+        stopping = false;
+        if (background)
+            worker = std::thread(&LevelGenerator::Run, this);
+    }
+
+    void Stop() {
+        if (!worker.joinable())
+            return;
+
+        stopping = true;
+        consumed.fetch_add(1, std::memory_order_release);
+        consumed.notify_one();
+        worker.join();
+
+        LevelChunk chunk;
+        while (queue.TryPop(chunk)) {}
+    }
+
+    // Takes the next chunk. Only waits if the worker has fallen behind.
+    void Next(LevelChunk& chunk) {
+        if (!worker.joinable()) {
+            Generate(chunk);
+            taken = chunk.end;
+            return;
+        }
+
+        while (true) {
+            unsigned int seen = produced.load(std::memory_order_acquire);
+            if (queue.TryPop(chunk))
+                break;
+            produced.wait(seen, std::memory_order_acquire);
+        }
+        taken = chunk.end;
+
+        consumed.fetch_add(1, std::memory_order_release);
+        consumed.notify_one();
+    }
+
+    // return : x of a platform dx to the side of anchorX, kept inside the window.
+    float PlatformX(float anchorX, float dx) const {
+        return std::clamp(anchorX + dx, 0.f, MaxX());
+    }
+};
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <atomic>
+#include <iostream>
+#include <string>
+
+#include "Dimension.h"
+#include "Framework.h"
+
+class MySprite {
+#ifdef _DEBUG
+    std::string spritePath;
+#endif
+    static inline std::atomic<unsigned int> nextId = 0;
+
+public:
+    Sprite* sprite;
+    Dimension size;
+    // Page the sprite was packed into by TextureAtlas, -1 if it isn't packed.
+    int atlasPage = -1;
+    // Number of sprites created before this one, DrawList groups draws by it.
+    unsigned int id;
+
+    MySprite(const char* path) : id(nextId++) {
+        sprite = createSprite(path);
+        int w, h;
+        getSpriteSize(sprite, w, h);
+        size = Dimension(w, h);
+#ifdef _DEBUG
+        spritePath = path;
+#endif
+    }
+
+    // Used for object copying.
+    //MySprite(const MySprite& other) {
+    //    spritePath = other.spritePath;
+    //    sprite = createSprite(other.spritePath);
+    //    int w, h;
+    //    getSpriteSize(sprite, w, h);
+    //    size = Dimension(w, h);
+    //}
+
+    void Draw(int x, int y) {
+        drawSprite(sprite, x, y);
+    }
+
+    ~MySprite() {
+#ifdef _DEBUG
+        std::cout << spritePath << " destroyed" << std::endl;
+#endif
+        destroySprite(sprite);
+    }
+};
@@ -0,0 +1,386 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <vector>
+
+#include "Animation.h"
+#include "BatchCollision.h"
+#include "Camera.h"
+#include "DrawList.h"
+#include "EntityStore.h"
+
+enum class Direction {
+    NONE,
+    LEFT,
+    RIGHT
+};
+
+// Bits of the key the player's pose is looked up by.
+enum PlayerPoseBit {
+    POSE_LEFT = 1,
+    POSE_JUMPING = 2,
+    POSE_SHOOTING = 4,
+    POSE_JETPACK = 8,
+    POSE_KEY_COUNT = 16
+};
+
+// Sprite slots of the player, in the order MyFramework loads them.
+enum PlayerSprite {
+    SPRITE_RIGHT,
+    SPRITE_LEFT,
+    SPRITE_RIGHT_JUMPING,
+    SPRITE_LEFT_JUMPING,
+    SPRITE_SHOOTING,
+    SPRITE_SHOOTING_JUMPING,
+    PLAYER_SPRITE_COUNT
+};
+
+// Shooting faces the screen whichever way the player faces, and flying on a jetpack shows the
+// jumping pose.
+constexpr AnimationTable<POSE_KEY_COUNT> MakePlayerAnimation() {
+    AnimationTable<POSE_KEY_COUNT> table;
+    for (unsigned int key = 0; key < POSE_KEY_COUNT; key++) {
+        bool jumping = key & (POSE_JUMPING | POSE_JETPACK);
+        PlayerSprite sprite = jumping ? SPRITE_RIGHT_JUMPING : SPRITE_RIGHT;
+        if (key & POSE_SHOOTING)
+            sprite = jumping ? SPRITE_SHOOTING_JUMPING : SPRITE_SHOOTING;
+        else if (key & POSE_LEFT)
+            sprite = jumping ? SPRITE_LEFT_JUMPING : SPRITE_LEFT;
+        table.clips[key] = AnimationClip{ (uint8_t)sprite };
+    }
+    return table;
+}
+
+constexpr AnimationTable<POSE_KEY_COUNT> playerAnimation = MakePlayerAnimation();
+
+// Everything about the player that changes while playing, as plain data, see Player::Save.
+struct PlayerState {
+    Dimension position;
+    Dimension previousPosition;
+    bool isVulnerable;
+    bool isFalling;
+    float jetpackTicks;
+    Direction lastMoveDirection;
+    Direction moveDirection;
+    float velocity;
+    bool maxHeightCapped;
+    int lives;
+    bool gameOver;
+    int distance;
+    int platformCount;
+    bool lastFalling;
+    float jumpingTicks;
+    float shootingTicks;
+    EntityHandle lastPassedPlatform;
+};
+
+class Entity {
+public:
+    MySprite** sprites;
+    int numSprites;
+    Dimension position;
+    // Position at the start of the current simulation step, used to interpolate rendering.
+    Dimension previousPosition;
+
+    Entity(MySprite** sprites, int numSprites, Dimension position)
+        : sprites(sprites), numSprites(numSprites), position(position), previousPosition(position) {}
+
+    ~Entity() {
+        //for (int i = 0; i < numSprites; i++) {
+        //    if (sprites[i])
+        //        delete sprites[i];
+        //}
+        delete[] sprites;
+    }
+
+    // Moves the entity without interpolating from its old position.
+    void Teleport(Dimension newPosition) {
+        position = newPosition;
+        previousPosition = newPosition;
+    }
+
+protected:
+    // param: alpha : fraction of a simulation step elapsed since the last one.
+    // param: top : world y drawn at the top edge of the window.
+    void Render(MySprite* sprite, float alpha, float top, DrawLayer layer, DrawList& drawList) const {
+        Dimension renderPosition = previousPosition + (position - previousPosition) * alpha;
+        drawList.Add(sprite, renderPosition.x, renderPosition.y - top, layer);
+    }
+};
+
+class Player : public Entity {
+    bool isVulnerable = true;
+    bool isFalling = false;
+    float jetpackTicks = 0;
+    // Broad-phase and narrow-phase results, kept between steps so collision passes don't allocate.
+    std::vector<unsigned int> candidates;
+    std::vector<unsigned int> hits;
+    std::vector<Contact> contacts;
+
+    void Jump(ObjectType objectType) {
+        switch (objectType) {
+        case ObjectType::JUMP:
+            velocity -= jumpSpeed;
+			break;
+        case ObjectType::JUMP_BOOST:
+            velocity -= boostSpeed;
+            break;
+        //case ObjectType::JETPACK:
+        //    //velocity -= 55;
+        //    jetpackTicks = 4500;
+        //    break;
+        default:
+            break;
+        }
+    }
+
+    void Jump() {
+        velocity -= jumpSpeed;
+    }
+
+    // Puts the player back on the lowest platform in view, briefly invulnerable.
+    void LoseLife(const EntityStore& objects, const Camera& camera) {
+        Dimension lowestPlatform = Dimension(0, camera.top);
+        size_t lowest = objects.Lowest();
+        if (lowest != EntityStore::none && objects.y[lowest] > lowestPlatform.y)
+            lowestPlatform = objects.Position(lowest);
+
+        Teleport(Dimension(lowestPlatform.x + this->sprites[0]->size.x / 4, lowestPlatform.y - this->sprites[0]->size.y));
+        lives--;
+        velocity = -1;
+        isVulnerable = false;
+    }
+
+    Box Bounds() const {
+        return Box{ position.x, position.y, sprites[0]->size.x, sprites[0]->size.y };
+    }
+
+public:
+    // Jump physics, in pixels and milliseconds. The level generator spaces platforms by them.
+    static constexpr float gravity = 0.0125f;
+    static constexpr float jumpSpeed = 3;
+    static constexpr float boostSpeed = 6;
+    static constexpr float moveSpeed = 1;
+
+    Direction lastMoveDirection = Direction::RIGHT;
+    Direction moveDirection = Direction::NONE;
+    float velocity = 0;
+    bool maxHeightCapped = false;
+    int lives = 5;
+    bool gameOver = false;
+    int distance = 0;
+    int platformCount = 0;
+    bool lastFalling = false;
+    float jumpingTicks = 0;
+    float shootingTicks = 0;
+    // Platform in the objects store, invalid once it has been culled.
+    EntityHandle lastPassedPlatform;
+
+    Player(MySprite** sprites, int numSprites, Dimension position)
+        : Entity(sprites, numSprites, position) {}
+
+    // Moves the player and the camera following it.
+    void Update(Camera& camera, Dimension windowSize, EntityStore& objects, EntityStore& enemies, float dt) {
+        float lastYPosition = position.y;
+
+        if (jetpackTicks)
+            velocity = -3;
+        else
+            velocity += gravity * dt;
+
+        position.y += velocity * dt;
+        isFalling = velocity > 0;
+
+        if (isFalling)
+            isVulnerable = true;
+
+        // The camera keeps the player from rising past the middle of the window, and never goes down.
+        float followY = camera.top + windowSize.y / 2 - this->sprites[0]->size.y / 2;
+        if (position.y < followY) {
+            int yPositionDelta = lastYPosition - position.y;
+            if (yPositionDelta > 0)
+                distance += yPositionDelta;
+
+            camera.top += position.y - followY;
+            maxHeightCapped = true;
+        }
+        else maxHeightCapped = false;
+
+        // HANDLE LIFES
+        if (lives >= 0 && position.y > camera.Bottom(windowSize.y) - this->sprites[0]->size.y / 2) {
+            LoseLife(objects, camera);
+        }
+
+        gameOver = lives < 0;
+
+        // COLLISIONS
+        float feet = position.y + sprites[0]->size.y;
+
+        candidates.clear();
+        enemies.Query(position.y, feet, candidates);
+        // A fixed order, so which enemy is met first doesn't depend on the order within index buckets.
+        std::sort(candidates.begin(), candidates.end(), std::greater<unsigned int>());
+
+        contacts.clear();
+        BatchCollision::FindContacts(Bounds(), velocity > 0, enemies.Boxes(), candidates.data(), candidates.size(), contacts);
+
+        for (Contact contact : contacts) {
+            size_t enemy = contact.index;
+            Collision collision = contact.collision;
+            // Stomping an earlier enemy this step bounced the player up, so this one can't be stomped too.
+            if (collision == Collision::TOP && velocity <= 0)
+                collision = Collision::OTHER;
+
+            if (isVulnerable && collision == Collision::OTHER) {
+                LoseLife(objects, camera);
+                break;
+            }
+            else if (collision == Collision::TOP) {
+                enemies.Destroy(enemy);
+                Jump();
+            }
+        }
+
+        // Hitting an enemy may have respawned the player.
+        feet = position.y + sprites[0]->size.y;
+        candidates.clear();
+        objects.Query(position.y, feet, candidates);
+        std::sort(candidates.begin(), candidates.end());
+
+        hits.clear();
+        BatchCollision::FindLandings(Bounds(), objects.Boxes(), candidates.data(), candidates.size(), hits);
+
+        if (!hits.empty()) {
+            unsigned int object = hits.front();
+
+            if (objects.type[object] == ObjectType::JETPACK && !jetpackTicks) {
+                jetpackTicks = 4500;
+                objects.Destroy(object);
+                isVulnerable = false;
+            }
+            else if (isFalling && objects.y[object] > position.y + sprites[0]->size.y - objects.height[object]) {
+                velocity = 0;
+                Jump(objects.type[object]);
+                jumpingTicks = 150;
+                if (objects.type[object] == ObjectType::JUMP_BOOST)
+                    objects.pose[object] |= SPRING_SPRUNG;
+            }
+        }
+
+        if (maxHeightCapped) {
+            // Only platforms between the player's feet and the last passed one can be newly passed.
+            size_t passed = objects.Find(lastPassedPlatform);
+            candidates.clear();
+            objects.Query(feet, passed == EntityStore::none ? camera.Bottom(windowSize.y) : objects.y[passed], candidates);
+            // Lowest first, so every platform passed counts whatever order the store keeps them in.
+            std::sort(candidates.begin(), candidates.end(), [&objects](unsigned int a, unsigned int b) {
+                return objects.y[a] != objects.y[b] ? objects.y[a] > objects.y[b] : a < b;
+            });
+
+            for (unsigned int object : candidates) {
+                if (objects.y[object] > feet &&
+                    (objects.type[object] == ObjectType::JUMP || objects.type[object] == JUMP_BOOST) &&
+                    (passed == EntityStore::none || objects.y[object] < objects.y[passed])) {
+                    platformCount++;
+                    passed = object;
+                }
+            }
+            if (passed != EntityStore::none)
+                lastPassedPlatform = objects.Handle(passed);
+        }
+
+        // MOVEMENT
+        switch (moveDirection) {
+        case Direction::RIGHT:
+            position.x += moveSpeed * dt;
+            lastMoveDirection = moveDirection;
+
+            if (position.x > windowSize.x) {
+                Teleport(Dimension(-sprites[0]->size.x, position.y));
+            }
+            break;
+        case Direction::LEFT:
+            position.x -= moveSpeed * dt;
+            lastMoveDirection = moveDirection;
+
+            if (position.x < -sprites[SPRITE_LEFT_JUMPING]->size.x) {
+                Teleport(Dimension(windowSize.x, position.y));
+            }
+            break;
+        case Direction::NONE:
+            break;
+        }
+
+        jumpingTicks = std::max(jumpingTicks - dt, 0.f);
+        shootingTicks = std::max(shootingTicks - dt, 0.f);
+        jetpackTicks = std::max(jetpackTicks - dt, 0.f);
+    }
+
+    // return : key of the pose for the facing, jumping, shooting and jetpack state.
+    unsigned int PoseKey() const {
+        return (lastMoveDirection == Direction::LEFT) * POSE_LEFT | (jumpingTicks > 0) * POSE_JUMPING |
+            (shootingTicks > 0) * POSE_SHOOTING | (jetpackTicks > 0) * POSE_JETPACK;
+    }
+
+    // param: time : milliseconds of simulated time, drives the frames of animated poses.
+    void Render(float alpha, float top, unsigned int time, DrawList& drawList) const {
+        Entity::Render(sprites[playerAnimation.Sprite(PoseKey(), time)], alpha, top, LAYER_PLAYER, drawList);
+    }
+
+    void Save(PlayerState& state) const {
+        state.position = position;
+        state.previousPosition = previousPosition;
+        state.isVulnerable = isVulnerable;
+        state.isFalling = isFalling;
+        state.jetpackTicks = jetpackTicks;
+        state.lastMoveDirection = lastMoveDirection;
+        state.moveDirection = moveDirection;
+        state.velocity = velocity;
+        state.maxHeightCapped = maxHeightCapped;
+        state.lives = lives;
+        state.gameOver = gameOver;
+        state.distance = distance;
+        state.platformCount = platformCount;
+        state.lastFalling = lastFalling;
+        state.jumpingTicks = jumpingTicks;
+        state.shootingTicks = shootingTicks;
+        state.lastPassedPlatform = lastPassedPlatform;
+    }
+
+    void Restore(const PlayerState& state) {
+        position = state.position;
+        previousPosition = state.previousPosition;
+        isVulnerable = state.isVulnerable;
+        isFalling = state.isFalling;
+        jetpackTicks = state.jetpackTicks;
+        lastMoveDirection = state.lastMoveDirection;
+        moveDirection = state.moveDirection;
+        velocity = state.velocity;
+        maxHeightCapped = state.maxHeightCapped;
+        lives = state.lives;
+        gameOver = state.gameOver;
+        distance = state.distance;
+        platformCount = state.platformCount;
+        lastFalling = state.lastFalling;
+        jumpingTicks = state.jumpingTicks;
+        shootingTicks = state.shootingTicks;
+        lastPassedPlatform = state.lastPassedPlatform;
+    }
+
+    void Reset() {
+        this->position = position;
+        this->velocity = 0;
+        this->moveDirection = Direction::NONE;
+        this->lastMoveDirection = Direction::RIGHT;
+        this->maxHeightCapped = false;
+        this->lives = 5;
+        this->gameOver = false;
+        this->distance = 0;
+        this->platformCount = 0;
+        this->isVulnerable = true;
+        this->jumpingTicks = 0;
+        this->shootingTicks = 0;
+        this->lastPassedPlatform = EntityHandle();
+    }
+};
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+
+// Per-game random number generator (xorshift64*, seeded through splitmix64). Unlike rand() it
+// belongs to one game and produces the same sequence on every platform and standard library, so a
+// seed plus an input log reproduces a game exactly.
+class Random {
+    uint64_t state = 1;
+
+public:
+    explicit Random(uint64_t seed = 0) {
+        Seed(seed);
+    }
+
+    void Seed(uint64_t seed) {
+        uint64_t z = seed + 0x9E3779B97F4A7C15ull;
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        state = (z ^ (z >> 31)) | 1;
+    }
+
+    // Whole generator state, restoring it with SetState continues the sequence from there.
+    uint64_t State() const {
+        return state;
+    }
+
+    void SetState(uint64_t newState) {
+        state = newState;
+    }
+
+    uint64_t Next() {
+        state ^= state >> 12;
+        state ^= state << 25;
+        state ^= state >> 27;
+        return state * 0x2545F4914F6CDD1Dull;
+    }
+
+    // return : number in [min, max].
+    int Range(int min, int max) {
+        return min + (int)((Next() >> 32) % (uint64_t)(max - min + 1));
+    }
+};
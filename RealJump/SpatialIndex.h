@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Broad-phase index for a vertical strip of entities. Entities are bucketed by the y of their top
+// edge relative to an offset, so shifting the whole world only moves the offset and a query
+// visits just the few rows of buckets it overlaps. Rows are kept in a ring, so entities far apart
+// may share a bucket; that only costs extra candidates, the narrow-phase test stays exact.
+class SpatialIndex {
+    float cellHeight;
+    std::vector<std::vector<unsigned int>> cells;
+    double offset = 0;
+    // Tallest entity ever inserted, queries reach this far above their range.
+    float maxHeight = 0;
+
+    std::vector<unsigned int>& Cell(int key) {
+        int count = (int)cells.size();
+        return cells[((key % count) + count) % count];
+    }
+
+    const std::vector<unsigned int>& Cell(int key) const {
+        int count = (int)cells.size();
+        return cells[((key % count) + count) % count];
+    }
+
+    int Key(double y) const {
+        return (int)std::floor((y - offset) / cellHeight);
+    }
+
+public:
+    SpatialIndex(float cellHeight = 64, int cellCount = 64) : cellHeight(cellHeight), cells(cellCount) {}
+
+    // Makes room for count entities in every cell, since any one cell may end up holding all of
+    // them, so inserting up to count entities never allocates.
+    void Reserve(size_t count) {
+        for (std::vector<unsigned int>& cell : cells)
+            cell.reserve(count);
+    }
+
+    // return : key of the cell the entity went into, needed to Erase or Rename it later.
+    int Insert(unsigned int index, float top, float height) {
+        int key = Key(top);
+        Cell(key).push_back(index);
+        maxHeight = std::max(maxHeight, height);
+        return key;
+    }
+
+    void Erase(unsigned int index, int key) {
+        std::vector<unsigned int>& cell = Cell(key);
+        auto found = std::find(cell.begin(), cell.end(), index);
+        *found = cell.back();
+        cell.pop_back();
+    }
+
+    // The entity stored under oldIndex is now known as newIndex.
+    void Rename(unsigned int oldIndex, unsigned int newIndex, int key) {
+        std::vector<unsigned int>& cell = Cell(key);
+        *std::find(cell.begin(), cell.end(), oldIndex) = newIndex;
+    }
+
+    // Every indexed entity moved down by dy.
+    void Shift(float dy) {
+        offset += dy;
+    }
+
+    void Clear() {
+        for (std::vector<unsigned int>& cell : cells)
+            cell.clear();
+        offset = 0;
+        maxHeight = 0;
+    }
+
+    double Offset() const {
+        return offset;
+    }
+
+    float MaxHeight() const {
+        return maxHeight;
+    }
+
+    // Empties the index and puts it back in the state Offset and MaxHeight were read from, so
+    // entities can be put back with InsertAt under the keys they had.
+    void Restore(double savedOffset, float savedMaxHeight) {
+        Clear();
+        offset = savedOffset;
+        maxHeight = savedMaxHeight;
+    }
+
+    void InsertAt(unsigned int index, int key) {
+        Cell(key).push_back(index);
+    }
+
+    // Appends every entity that may overlap the rows between top and bottom, each at most once.
+    void Query(float top, float bottom, std::vector<unsigned int>& candidates) const {
+        // One cell of slack on both ends absorbs rounding drift between entity positions and the offset.
+        int first = Key(top - maxHeight) - 1;
+        int last = std::min(Key(bottom) + 1, first + (int)cells.size() - 1);
+
+        for (int key = first; key <= last; key++) {
+            const std::vector<unsigned int>& cell = Cell(key);
+            candidates.insert(candidates.end(), cell.begin(), cell.end());
+        }
+    }
+};
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+
+// Bounded lock-free queue between exactly one producer thread and one consumer thread. Items are
+// copied into a fixed ring, so neither side ever allocates or waits on the other; TryPush fails
+// when the ring is full and TryPop when it is empty.
+template <typename T, size_t Capacity>
+class SpscQueue {
+    std::array<T, Capacity> items;
+    // Next slot to write, only advanced by the producer.
+    alignas(64) std::atomic<size_t> head = 0;
+    // Next slot to read, only advanced by the consumer.
+    alignas(64) std::atomic<size_t> tail = 0;
+
+public:
+    bool TryPush(const T& item) {
+        size_t position = head.load(std::memory_order_relaxed);
+        if (position - tail.load(std::memory_order_acquire) == Capacity)
+            return false;
+
+        items[position % Capacity] = item;
+        head.store(position + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool TryPop(T& item) {
+        size_t position = tail.load(std::memory_order_relaxed);
+        if (position == head.load(std::memory_order_acquire))
+            return false;
+
+        item = items[position % Capacity];
+        tail.store(position + 1, std::memory_order_release);
+        return true;
+    }
+};
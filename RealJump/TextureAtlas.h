@@ -0,0 +1,98 @@
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include "AssetRegistry.h"
+
+struct AtlasRegion {
+    int page = -1;
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Packs a scene's sprites into square pages with a shelf packer, tallest sprites first. Every packed
+// MySprite is tagged with its page, which DrawList uses to submit runs of same-page draws as one batch.
+// Pages are only a layout: the framework keeps drawing every sprite from its own texture, so a batch
+// saves per-call overhead but no texture binds until sprites are actually copied into page textures.
+class TextureAtlas {
+    int pageSize;
+    int padding;
+    int pageCount = 0;
+    size_t usedPixels = 0;
+    // Indexed by SpriteHandle::index.
+    std::vector<AtlasRegion> regions;
+
+public:
+    explicit TextureAtlas(int pageSize = 2048, int padding = 1) : pageSize(pageSize), padding(padding) {}
+
+    void Build(const AssetRegistry& assets, std::vector<SpriteHandle> sprites) {
+        std::sort(sprites.begin(), sprites.end(), [&assets](SpriteHandle a, SpriteHandle b) {
+            return assets[a]->size.y > assets[b]->size.y;
+        });
+
+        regions.clear();
+        pageCount = 0;
+        usedPixels = 0;
+
+        int shelfX = 0, shelfY = 0, shelfHeight = 0;
+
+        for (SpriteHandle handle : sprites) {
+            MySprite* sprite = assets[handle];
+            int w = (int)sprite->size.x + padding;
+            int h = (int)sprite->size.y + padding;
+            bool oversized = w > pageSize || h > pageSize;
+
+            if (pageCount == 0 || shelfX + w > pageSize) {
+                // Start a new shelf below the current one.
+                shelfY += shelfHeight;
+                shelfX = 0;
+                shelfHeight = 0;
+            }
+
+            if (pageCount == 0 || oversized || shelfY + h > pageSize) {
+                // Start a new page, sprites larger than a page in either direction get one of their own.
+                pageCount++;
+                shelfX = 0;
+                shelfY = 0;
+                shelfHeight = 0;
+            }
+
+            AtlasRegion region;
+            region.page = pageCount - 1;
+            region.x = shelfX;
+            region.y = shelfY;
+            region.width = (int)sprite->size.x;
+            region.height = (int)sprite->size.y;
+
+            if (regions.size() <= handle.index)
+                regions.resize(handle.index + 1);
+            regions[handle.index] = region;
+            sprite->atlasPage = region.page;
+
+            shelfX += w;
+            shelfHeight = std::max(shelfHeight, h);
+            if (oversized) {
+                // Nothing else goes on its page.
+                shelfX = pageSize;
+                shelfY = pageSize;
+            }
+            usedPixels += (size_t)region.width * region.height;
+        }
+    }
+
+    const AtlasRegion& Region(SpriteHandle handle) const {
+        return regions[handle.index];
+    }
+
+    int PageCount() const {
+        return pageCount;
+    }
+
+    // Share of the allocated page area covered by sprites.
+    float FillRatio() const {
+        return pageCount ? (float)usedPixels / ((float)pageSize * pageSize * pageCount) : 0.f;
+    }
+};
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool for data-parallel loops. ParallelFor deals the ranges of a loop out to one
+// queue per thread; each thread works through its own queue from the back and, once it is empty,
+// steals from the front of the others, so uneven ranges even out without a central queue. The
+// calling thread takes part too.
+class ThreadPool {
+    struct Range {
+        size_t begin;
+        size_t end;
+    };
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+    };
+
+    std::vector<std::thread> threads;
+    // Queue 0 belongs to the calling thread, queue i to threads[i - 1].
+    std::vector<std::unique_ptr<Queue>> queues;
+    const std::function<void(size_t, size_t)>* job = nullptr;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    unsigned int generation = 0;
+    // Threads still working on the current job.
+    size_t active = 0;
+    bool stopping = false;
+
+    bool Pop(size_t queue, Range& range) {
+        std::lock_guard<std::mutex> lock(queues[queue]->mutex);
+        if (queues[queue]->ranges.empty())
+            return false;
+
+        range = queues[queue]->ranges.back();
+        queues[queue]->ranges.pop_back();
+        return true;
+    }
+
+    bool Steal(size_t thief, Range& range) {
+        for (size_t i = 1; i < queues.size(); i++) {
+            Queue& victim = *queues[(thief + i) % queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.ranges.empty()) {
+                range = victim.ranges.front();
+                victim.ranges.pop_front();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Runs ranges until every queue is empty.
+    void RunRanges(size_t queue) {
+        Range range;
+        while (Pop(queue, range) || Steal(queue, range))
+            (*job)(range.begin, range.end);
+    }
+
+    void Work(size_t queue) {
+        unsigned int seen = 0;
+        while (true) {
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping)
+                    return;
+                seen = generation;
+            }
+
+            RunRanges(queue);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            if (--active == 0)
+                done.notify_one();
+        }
+    }
+
+public:
+    // param: threadCount : threads including the calling one, 0 for one per hardware thread.
+    explicit ThreadPool(unsigned int threadCount = 0) {
+        if (threadCount == 0)
+            threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+        for (unsigned int i = 0; i < threadCount; i++)
+            queues.push_back(std::make_unique<Queue>());
+        for (unsigned int i = 1; i < threadCount; i++)
+            threads.emplace_back(&ThreadPool::Work, this, i);
+    }
+
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t ThreadCount() const {
+        return queues.size();
+    }
+
+    // Calls function(begin, end) over [0, count) in ranges of at most grain items, spread over all
+    // threads, and returns once every range is done. function must be safe to call concurrently.
+    void ParallelFor(size_t count, size_t grain, const std::function<void(size_t, size_t)>& function) {
+        grain = std::max<size_t>(grain, 1);
+        if (threads.empty() || count <= grain) {
+            for (size_t begin = 0; begin < count; begin += grain)
+                function(begin, std::min(begin + grain, count));
+            return;
+        }
+
+        size_t range = 0;
+        for (size_t begin = 0; begin < count; begin += grain, range++) {
+            Queue& queue = *queues[range % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            queue.ranges.push_back(Range{ begin, std::min(begin + grain, count) });
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = &function;
+            active = threads.size();
+            generation++;
+        }
+        wake.notify_all();
+
+        RunRanges(0);
+
+        // Every thread leaves RunRanges only once all queues are empty, so when the last one is back
+        // every range has run and the next job can't be mixed up with this one.
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return active == 0; });
+        job = nullptr;
+    }
+};
@@ -0,0 +1,530 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "Game.h"
+#include "GameBatch.h"
+#include "FrameworkHeadless.h"
+
+// Benchmarks of the simulation hot paths, run on the headless backend and printed as one JSON
+// document on stdout, so runs can be diffed and compared by scripts.
+//
+// Microbenchmarks time one phase of the simulation at a time against synthetic populations of 10 to
+// 100k entities and report the time per call and per entity. Scenario benchmarks play whole games
+// with a fixed seed and scripted input and report ticks per second, along with the final state hash
+// so a speed-up can be checked not to have changed the game. Batch benchmarks step many games at
+// once through GameBatch on every core and report the aggregate simulation steps per second.
+//
+// Usage: RealJumpBenchmark [-quick]
+
+using Clock = std::chrono::steady_clock;
+
+struct MicroResult {
+    std::string name;
+    size_t entities;
+    double nsPerOp;
+};
+
+struct BatchResult {
+    std::string name;
+    size_t games;
+    size_t threads;
+    uint64_t steps;
+    double stepsPerSecond;
+};
+
+struct ScenarioResult {
+    std::string name;
+    unsigned long long ticks;
+    unsigned int steps;
+    unsigned long long drawCalls;
+    // Per rendered frame, see DrawList.
+    double drawsPerFrame;
+    double culledPerFrame;
+    size_t maxDraws;
+    // Milliseconds from input to the first frame showing it.
+    uint64_t inputLatencyP50;
+    uint64_t inputLatencyP99;
+    double ticksPerSecond;
+    uint64_t stateHash;
+};
+
+class GameBenchmark {
+    static constexpr int windowWidth = 800;
+    static constexpr int windowHeight = 1000;
+    static constexpr size_t populations[] = { 10, 100, 1000, 10000, 100000 };
+
+    // Minimum time spent timing each benchmark, in seconds.
+    double budget;
+    std::mt19937 random{ 42 };
+    std::vector<MicroResult> micro;
+    std::vector<ScenarioResult> scenarios;
+    std::vector<BatchResult> batches;
+
+    // Calls op until budget has elapsed, in rounds so the clock isn't read every call.
+    // return : nanoseconds per call.
+    template <typename Op>
+    double Measure(Op op) {
+        size_t calls = 0;
+        size_t round = 1;
+        Clock::time_point start = Clock::now();
+        double seconds = 0;
+
+        while (seconds < budget) {
+            for (size_t i = 0; i < round; i++)
+                op();
+            calls += round;
+            round = std::min<size_t>(round * 2, 1024);
+            seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        }
+        return seconds * 1e9 / calls;
+    }
+
+    void Report(const std::string& name, size_t entities, double nsPerOp) {
+        micro.push_back(MicroResult{ name, entities, nsPerOp });
+        std::fprintf(stderr, "%-28s %7zu entities %12.1f ns/op %9.2f ns/entity\n", name.c_str(), entities,
+            nsPerOp, nsPerOp / std::max<size_t>(entities, 1));
+    }
+
+    // A game with its assets loaded and its stores large enough for the biggest population. It
+    // generates the level inline, the way batched games do, so restoring a snapshot doesn't restart
+    // the worker thread.
+    static MyFramework* CreateGame() {
+        GameOptions options;
+        options.entityCapacity = populations[std::size(populations) - 1] + 16;
+        options.hasSeed = true;
+        options.seed = 1;
+        options.levelThread = false;
+        options.streamAssets = false;
+
+        MyFramework* game = new MyFramework(windowWidth, windowHeight, options);
+        int width, height;
+        bool fullscreen;
+        game->PreInit(width, height, fullscreen);
+        if (!game->Init()) {
+            delete game;
+            return nullptr;
+        }
+        return game;
+    }
+
+    static void DestroyGame(MyFramework* game) {
+        game->Close();
+        delete game;
+    }
+
+    // Fills store with count entities of sprite spread over [top, bottom) of the window.
+    void Populate(MyFramework& game, EntityStore& store, SpriteHandle sprite, size_t count, float top, float bottom,
+        ObjectType type = ObjectType::DEFAULT, Dimension direction = Dimension()) {
+        std::uniform_real_distribution<float> x(0, windowWidth - game.assets[sprite]->size.x);
+        std::uniform_real_distribution<float> y(top, bottom - game.assets[sprite]->size.y);
+        for (size_t i = 0; i < count; i++)
+            store.Add(sprite, Dimension(x(random), y(random)), type, direction);
+    }
+
+    // Player::Update over platforms everywhere and enemies kept clear of the player, so every call
+    // runs the same collision passes without changing the stores.
+    void PlayerUpdate(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count, 0, windowHeight, ObjectType::JUMP);
+        Populate(game, game.enemies, game.enemySprites[0], count, 0, windowHeight / 4);
+
+        Player& player = *game.player;
+        Dimension start(windowWidth / 2, windowHeight / 2);
+        game.camera = Camera();
+        Report("player_update", count, Measure([&] {
+            player.Reset();
+            player.Teleport(start);
+            player.velocity = 1;
+            player.Update(game.camera, game.windowSize, game.objects, game.enemies, simulationStep);
+        }));
+    }
+
+    // Projectiles flying sideways through the top half of the window, enemies in the bottom half.
+    void ProjectileUpdate(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.projectiles, game.projectileSprite, count, 0, windowHeight / 2 - 100,
+            ObjectType::DEFAULT, Dimension(1, 0));
+        Populate(game, game.enemies, game.enemySprites[0], count, windowHeight / 2 + 100, windowHeight);
+
+        Report("projectile_update", count, Measure([&] {
+            game.UpdateProjectiles(simulationStep);
+        }));
+    }
+
+    // Moves the camera up and back down by a pixel and culls, nothing gets culled. Scrolling only
+    // moves the camera, so this is the cull alone.
+    void ScrollCull(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count, 0, windowHeight - 2, ObjectType::JUMP);
+        Populate(game, game.enemies, game.enemySprites[0], count, 0, windowHeight - 2);
+
+        game.camera = Camera();
+        float scroll = -1;
+        Report("scroll_cull", 2 * count, Measure([&] {
+            game.camera.top += scroll;
+            game.CullWorld();
+            scroll = -scroll;
+        }));
+    }
+
+    void BroadPhaseQuery(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count, 0, windowHeight, ObjectType::JUMP);
+
+        std::vector<unsigned int> candidates;
+        float top = 0;
+        Report("broad_phase_query", count, Measure([&] {
+            candidates.clear();
+            game.objects.Query(top, top + 120, candidates);
+            top = top < windowHeight - 120 ? top + 7 : 0;
+        }));
+    }
+
+    // The batch collision kernels against the pairwise test they replaced, over the platform boxes
+    // both as a contiguous range and through a shuffled index list, the way broad-phase results
+    // are passed in.
+    void CollisionKernels(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count, 0, windowHeight, ObjectType::JUMP);
+
+        std::vector<unsigned int> indices(count);
+        for (size_t i = 0; i < count; i++)
+            indices[i] = (unsigned int)i;
+        std::shuffle(indices.begin(), indices.end(), random);
+
+        ReportKernel("collision_pairwise", game, indices, FindOverlapsPairwise);
+        ReportKernel("collision_scalar", game, indices, BatchCollision::FindOverlaps<BatchCollision::ScalarLanes>);
+#if defined(REALJUMP_COLLISION_SSE) || defined(REALJUMP_COLLISION_AVX)
+        ReportKernel("collision_sse", game, indices, BatchCollision::FindOverlaps<BatchCollision::SseLanes>);
+#endif
+#if defined(REALJUMP_COLLISION_AVX)
+        ReportKernel("collision_avx", game, indices, BatchCollision::FindOverlaps<BatchCollision::AvxLanes>);
+#endif
+    }
+
+    template <typename Kernel>
+    void ReportKernel(const std::string& name, MyFramework& game, const std::vector<unsigned int>& indices, Kernel kernel) {
+        std::vector<unsigned int> hits;
+        hits.reserve(indices.size());
+        BoxArrays boxes = game.objects.Boxes();
+        float x = 350;
+
+        for (int indexed = 0; indexed < 2; indexed++) {
+            Report(name + (indexed ? "_indexed" : "_range"), indices.size(), Measure([&] {
+                hits.clear();
+                // Move the box a little, so the compiler can't hoist the work out of the loop.
+                x = x < 400 ? x + 1 : 350;
+                kernel(Box{ x, 450, 80, 80 }, boxes, indexed ? indices.data() : nullptr, indices.size(), hits);
+            }));
+        }
+    }
+
+    // The scalar test the kernels replaced, with its early outs.
+    static void FindOverlapsPairwise(Box box, BoxArrays boxes, const unsigned int* indices, size_t count,
+        std::vector<unsigned int>& hits) {
+        for (size_t i = 0; i < count; i++) {
+            unsigned int other = indices ? indices[i] : (unsigned int)i;
+            if (box.y + box.height < boxes.y[other] ||
+                box.y > boxes.y[other] + boxes.height[other] ||
+                box.x + box.width < boxes.x[other] ||
+                box.x > boxes.x[other] + boxes.width[other]) {
+                continue;
+            }
+            hits.push_back(other);
+        }
+    }
+
+    // Saving and restoring the whole game with count entities in each store. The stores are emptied
+    // between the two, so the restore has to bring every entity back.
+    // return : false if the snapshot couldn't hold the game or didn't restore the state saved.
+    bool Snapshot(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count, 0, windowHeight, ObjectType::JUMP);
+        Populate(game, game.enemies, game.enemySprites[0], count, 0, windowHeight);
+        Populate(game, game.projectiles, game.projectileSprite, count, 0, windowHeight);
+
+        // Too large for the stack on some platforms.
+        std::unique_ptr<GameSnapshot> snapshot = std::make_unique<GameSnapshot>();
+        uint64_t saved = game.ComputeStateHash();
+        bool fits = true;
+        Report("snapshot_save", 3 * count, Measure([&] {
+            fits = game.SaveSnapshot(*snapshot);
+        }));
+        if (!fits) {
+            std::fprintf(stderr, "snapshot: %zu entities per store don't fit\n", count);
+            return false;
+        }
+
+        game.CleanUp();
+        Report("snapshot_restore", 3 * count, Measure([&] {
+            game.RestoreSnapshot(*snapshot);
+        }));
+        if (game.ComputeStateHash() != saved) {
+            std::fprintf(stderr, "snapshot: %zu entities per store restored to a different state\n", count);
+            return false;
+        }
+        return true;
+    }
+
+    // Recording and submitting platforms spread over three window heights, two of them off screen,
+    // so most draws are culled.
+    void RenderQueue(MyFramework& game, size_t count) {
+        game.CleanUp();
+        Populate(game, game.objects, game.greenPlatformSprite, count / 2, -windowHeight, 2 * windowHeight, ObjectType::JUMP);
+        Populate(game, game.objects, game.bluePlatformSprite, count - count / 2, -windowHeight, 2 * windowHeight,
+            ObjectType::JUMP_BOOST);
+
+        Report("render_queue", count, Measure([&] {
+            game.objects.Render(0, 0, LAYER_OBJECTS, game.drawList);
+            game.drawList.Submit();
+        }));
+    }
+
+    // Laying out and drawing the HUD counters, with a value that stays the same and one that changes
+    // every frame.
+    void HudText(MyFramework& game) {
+        int value = 123456;
+        Report("hud_text_stable", 1, Measure([&] {
+            game.distanceText.SetNumber(value, game.glyphs, game.assets);
+            game.distanceText.Render(game.drawList);
+            game.drawList.Submit();
+        }));
+
+        Report("hud_text_changing", 1, Measure([&] {
+            game.distanceText.SetNumber(value++, game.glyphs, game.assets);
+            game.distanceText.Render(game.drawList);
+            game.drawList.Submit();
+        }));
+    }
+
+    // Plays a game the way the headless executable does, feeding it input from a seeded script.
+    class ScenarioDriver : public Framework {
+        MyFramework* game;
+        bool autoplay;
+        Random input;
+        unsigned long long tick = 0;
+        ScenarioResult& result;
+
+    public:
+        ScenarioDriver(MyFramework* game, bool autoplay, ScenarioResult& result)
+            : game(game), autoplay(autoplay), input(7), result(result) {}
+
+        ~ScenarioDriver() {
+            delete game;
+        }
+
+        void PreInit(int& width, int& height, bool& fullscreen) override {
+            game->PreInit(width, height, fullscreen);
+        }
+
+        bool Init() override {
+            return game->Init();
+        }
+
+        void Close() override {
+            result.steps = game->stepCount;
+            result.stateHash = game->ComputeStateHash();
+            const RenderStats& render = game->renderStats;
+            result.drawsPerFrame = render.frames ? (double)render.submitted / render.frames : 0;
+            result.culledPerFrame = render.frames ? (double)render.culled / render.frames : 0;
+            result.maxDraws = render.maxSubmitted;
+            result.inputLatencyP50 = game->inputLatency.Percentile(0.5);
+            result.inputLatencyP99 = game->inputLatency.Percentile(0.99);
+            game->Close();
+        }
+
+        bool Tick() override {
+            if (autoplay) {
+                // Change direction every 700 ticks, aim and shoot every 97.
+                if (tick % 700 == 0) {
+                    game->onKeyReleased(FRKey::LEFT);
+                    game->onKeyReleased(FRKey::RIGHT);
+                    if (int direction = input.Range(0, 2))
+                        game->onKeyPressed(direction == 1 ? FRKey::LEFT : FRKey::RIGHT);
+                }
+                if (tick % 97 == 0) {
+                    game->onMouseMove(input.Range(0, windowWidth), input.Range(0, windowHeight / 2), 0, 0);
+                    game->onMouseButtonClick(FRMouseButton::LEFT, false);
+                    game->onMouseButtonClick(FRMouseButton::LEFT, true);
+                }
+            }
+            tick++;
+            return game->Tick();
+        }
+
+        void onMouseMove(int, int, int, int) override {}
+        void onMouseButtonClick(FRMouseButton, bool) override {}
+        void onKeyPressed(FRKey) override {}
+        void onKeyReleased(FRKey) override {}
+
+        const char* GetTitle() override {
+            return game->GetTitle();
+        }
+    };
+
+    void Scenario(const std::string& name, bool autoplay, bool rendering, unsigned long long ticks,
+        bool pipelined = false) {
+        GameOptions options;
+        options.renderingEnabled = rendering;
+        options.pipelined = pipelined;
+        // Loading in the background takes a varying number of ticks, which would make the results vary too.
+        options.streamAssets = false;
+        options.hasSeed = true;
+        options.seed = 1;
+
+        ScenarioResult result{};
+        result.name = name;
+        setHeadlessTickLimit(ticks);
+        setHeadlessTickStep(1);
+        run(new ScenarioDriver(new MyFramework(windowWidth, windowHeight, options), autoplay, result));
+
+        HeadlessStats stats;
+        getHeadlessStats(stats);
+        result.ticks = stats.ticks;
+        result.drawCalls = stats.drawCalls;
+        result.ticksPerSecond = stats.wallSeconds > 0 ? stats.ticks / stats.wallSeconds : 0;
+        scenarios.push_back(result);
+    }
+
+    // Moves towards the nearest platform above the player, and shoots at the nearest enemy.
+    static BatchAction Climb(const Observation& observation) {
+        BatchAction action;
+        for (unsigned int i = 0; i < observation.nearbyCount; i++) {
+            const ObservedEntity& entity = observation.nearby[i];
+            if (entity.kind == OBSERVED_ENEMY && !action.shoot) {
+                action.shoot = true;
+                action.aimX = entity.x + entity.width / 2;
+                action.aimY = entity.y + entity.height / 2;
+            }
+            else if (entity.kind != OBSERVED_ENEMY && action.move == Direction::NONE && entity.y < observation.y) {
+                float dx = entity.x + entity.width / 2 - (observation.x + 46);
+                action.move = dx > 8 ? Direction::RIGHT : dx < -8 ? Direction::LEFT : Direction::NONE;
+            }
+        }
+        return action;
+    }
+
+    // Many games stepped by GameBatch, either all together one step at a time or each on its own.
+    void Batch(const std::string& name, bool lockstep, size_t gameCount, unsigned int steps) {
+        GameBatch batch(gameCount, 1);
+        std::vector<BatchAction> actions(batch.Size());
+
+        Clock::time_point start = Clock::now();
+        if (lockstep) {
+            for (unsigned int step = 0; step < steps; step++) {
+                for (size_t i = 0; i < batch.Size(); i++)
+                    actions[i] = Climb(batch.Observations()[i]);
+                batch.Step(actions.data());
+            }
+        }
+        else {
+            batch.Run(steps, [](size_t, const Observation& observation) { return Climb(observation); });
+        }
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+        uint64_t total = (uint64_t)batch.Size() * steps;
+        batches.push_back(BatchResult{ name, batch.Size(), batch.ThreadCount(), total, total / seconds });
+        std::fprintf(stderr, "%-28s %7zu games %3zu threads %12.0f steps/s\n", name.c_str(), batch.Size(),
+            batch.ThreadCount(), total / seconds);
+    }
+
+    void PrintJson() const {
+        std::printf("{\n  \"micro\": [\n");
+        for (size_t i = 0; i < micro.size(); i++) {
+            const MicroResult& m = micro[i];
+            std::printf("    {\"name\": \"%s\", \"entities\": %zu, \"ns_per_op\": %.2f, \"ns_per_entity\": %.4f}%s\n",
+                m.name.c_str(), m.entities, m.nsPerOp, m.nsPerOp / std::max<size_t>(m.entities, 1),
+                i + 1 < micro.size() ? "," : "");
+        }
+        std::printf("  ],\n  \"scenarios\": [\n");
+        for (size_t i = 0; i < scenarios.size(); i++) {
+            const ScenarioResult& s = scenarios[i];
+            std::printf("    {\"name\": \"%s\", \"ticks\": %llu, \"steps\": %u, \"draw_calls\": %llu, "
+                "\"draws_per_frame\": %.1f, \"culled_per_frame\": %.1f, \"max_draws\": %zu, "
+                "\"input_latency_p50_ms\": %llu, \"input_latency_p99_ms\": %llu, "
+                "\"ticks_per_second\": %.1f, \"state_hash\": \"%016llx\"}%s\n",
+                s.name.c_str(), s.ticks, s.steps, s.drawCalls, s.drawsPerFrame, s.culledPerFrame, s.maxDraws,
+                (unsigned long long)s.inputLatencyP50, (unsigned long long)s.inputLatencyP99, s.ticksPerSecond,
+                (unsigned long long)s.stateHash, i + 1 < scenarios.size() ? "," : "");
+        }
+        std::printf("  ],\n  \"batches\": [\n");
+        for (size_t i = 0; i < batches.size(); i++) {
+            const BatchResult& b = batches[i];
+            std::printf("    {\"name\": \"%s\", \"games\": %zu, \"threads\": %zu, \"steps\": %llu, "
+                "\"steps_per_second\": %.1f}%s\n", b.name.c_str(), b.games, b.threads, (unsigned long long)b.steps,
+                b.stepsPerSecond, i + 1 < batches.size() ? "," : "");
+        }
+        std::printf("  ]\n}\n");
+    }
+
+public:
+    explicit GameBenchmark(bool quick) : budget(quick ? 0.02 : 0.2) {}
+
+    // return : false if the game failed to start, a snapshot didn't restore its game or the autoplay
+    // scenarios ended in different states.
+    bool Run(unsigned long long scenarioTicks, unsigned int batchSteps) {
+        MyFramework* game = CreateGame();
+        if (!game)
+            return false;
+
+        for (size_t count : populations) {
+            PlayerUpdate(*game, count);
+            ProjectileUpdate(*game, count);
+            ScrollCull(*game, count);
+            BroadPhaseQuery(*game, count);
+            RenderQueue(*game, count);
+        }
+        for (size_t count : { 1000, 10000, 100000 })
+            CollisionKernels(*game, count);
+        bool snapshotsRestored = true;
+        for (size_t count : populations) {
+            if (count <= StoreSnapshot::capacity)
+                snapshotsRestored &= Snapshot(*game, count);
+        }
+        HudText(*game);
+        DestroyGame(game);
+
+        Scenario("idle", false, true, scenarioTicks);
+        Scenario("autoplay", true, true, scenarioTicks);
+        Scenario("autoplay_norender", true, false, scenarioTicks);
+        Scenario("autoplay_pipelined", true, true, scenarioTicks, true);
+
+        Batch("batch_lockstep", true, 256, batchSteps);
+        Batch("batch_independent", false, 256, batchSteps);
+
+        PrintJson();
+
+        if (!snapshotsRestored)
+            return false;
+
+        // The autoplay scenarios get the same input, so rendering or not and pipelining or not must
+        // not change where they end.
+        const ScenarioResult* autoplay = &scenarios[1];
+        for (const ScenarioResult* other : { &scenarios[2], &scenarios[3] }) {
+            if (other->stateHash != autoplay->stateHash) {
+                std::fprintf(stderr, "%s ended in state %016llx, %s in %016llx\n", other->name.c_str(),
+                    (unsigned long long)other->stateHash, autoplay->name.c_str(),
+                    (unsigned long long)autoplay->stateHash);
+                return false;
+            }
+        }
+        return true;
+    }
+};
+
+int main(int argc, char* argv[]) {
+    bool quick = argc > 1 && std::strcmp(argv[1], "-quick") == 0;
+    if (argc > 2 || (argc == 2 && !quick)) {
+        std::fprintf(stderr, "Usage: %s [-quick]\n", argv[0]);
+        return 1;
+    }
+
+    GameBenchmark benchmark(quick);
+    return benchmark.Run(quick ? 20000 : 200000, quick ? 500 : 5000) ? 0 : 1;
+}